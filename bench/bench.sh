@@ -0,0 +1,165 @@
+#!/bin/sh
+# Performance benchmark suite (make bench). On synthetic workloads it measures:
+#   compile  wizuallc C generation for programs of BENCH_STATEMENTS statements (stmt/s)
+#   load     a generated program loading every column of a .dat file (MB/s of text)
+#   stream   the same file reduced by a streaming load (MB/s of text)
+#   reduce   sum/min_val/max_val/mean over a loaded column (GB/s of doubles read)
+# and the peak RSS of each run. Results go to BENCH_OUT as one JSON object per
+# line; with BENCH_BASELINE set to an earlier results file they are compared,
+# and the script exits 1 if any throughput dropped (or RSS grew) by more than
+# BENCH_TOLERANCE percent.
+#
+# usage: bench/bench.sh [path/to/wizuallc] [path/to/benchtool]
+#
+# Environment (defaults in parentheses):
+#   BENCH_ROWS        Data file rows ("1000 100000 1000000 10000000"; add 100000000 for the full range)
+#   BENCH_COLS        Column counts ("1 4 16")
+#   BENCH_MAX_VALUES  Skip multi-column files with more values than this (40000000)
+#   BENCH_STATEMENTS  Program sizes ("100 1000 10000 100000 1000000")
+#   BENCH_OUT         Results file (bench-results.jsonl)
+#   BENCH_BASELINE    Results file to compare against (none)
+#   BENCH_TOLERANCE   Allowed regression in percent (10)
+
+WIZUALLC=${1:-./wizuallc}
+BENCHTOOL=${2:-build/benchtool}
+ROWS=${BENCH_ROWS:-"1000 100000 1000000 10000000"}
+COLS=${BENCH_COLS:-"1 4 16"}
+MAX_VALUES=${BENCH_MAX_VALUES:-40000000}
+STATEMENTS=${BENCH_STATEMENTS:-"100 1000 10000 100000 1000000"}
+OUT=${BENCH_OUT:-bench-results.jsonl}
+TOLERANCE=${BENCH_TOLERANCE:-10}
+
+for tool in "$WIZUALLC" "$BENCHTOOL"; do
+    if [ ! -x "$tool" ]; then
+        echo "$tool not found (run make first)" >&2
+        exit 1
+    fi
+done
+case $WIZUALLC in /*) ;; *) WIZUALLC=$(pwd)/$WIZUALLC ;; esac
+case $BENCHTOOL in /*) ;; *) BENCHTOOL=$(pwd)/$BENCHTOOL ;; esac
+
+TMP=$(mktemp -d "${TMPDIR:-/tmp}/wizuall-bench.XXXXXX") || exit 1
+trap 'rm -rf "$TMP"' EXIT INT TERM
+export WIZUALL_CACHE_DIR="$TMP/cache" # Native builds stay out of the user's cache
+
+# measure <command...>: runs it in $TMP (data files are named relative to it),
+# setting $secs and $rss (peak RSS in KiB)
+measure() {
+    if ! (cd "$TMP" && "$BENCHTOOL" measure "$TMP/measure" "$@" > /dev/null 2> "$TMP/err.log"); then
+        echo "benchmark command failed: $*" >&2
+        cat "$TMP/err.log" >&2
+        exit 1
+    fi
+    read -r secs rss < "$TMP/measure"
+}
+
+# build <program.wzu> <executable> [wizuallc options...]
+build() {
+    src=$1 exe=$2
+    shift 2
+    if ! "$WIZUALLC" --build "$@" "$src" "$exe" 2> "$TMP/err.log"; then
+        echo "wizuallc --build failed for $src" >&2
+        cat "$TMP/err.log" >&2
+        exit 1
+    fi
+}
+
+# record <bench> <size> <cols> <bytes> <seconds> <work> <unit> <rss_kb>
+# Throughput is work / seconds, scaled to unit (MB/s and GB/s count 1e6/1e9 bytes)
+record() {
+    awk -v b="$1" -v n="$2" -v c="$3" -v bytes="$4" -v s="$5" -v w="$6" -v u="$7" -v rss="$8" -v out="$OUT" 'BEGIN {
+        scale = (u == "MB/s") ? 1e6 : (u == "GB/s") ? 1e9 : 1
+        t = (s > 0) ? w / s / scale : 0
+        printf "{\"bench\":\"%s\",\"size\":%d,\"cols\":%d,\"bytes\":%d,\"seconds\":%.6f,\"throughput\":%.3f,\"unit\":\"%s\",\"peak_rss_kb\":%d}\n",
+               b, n, c, bytes, s, t, u, rss >> out
+        printf "%-8s %10d %3d cols %10.3f s %12.2f %-7s %9d KiB\n", b, n, c, s, t, u, rss
+    }'
+}
+
+: > "$OUT"
+printf '{"bench":"meta","date":"%s","host":"%s","commit":"%s"}\n' "$(date -u +%Y-%m-%dT%H:%M:%SZ)" \
+    "$(uname -n)" "$(git rev-parse --short HEAD 2> /dev/null)" >> "$OUT"
+printf '%-8s %10s %8s %12s %20s %13s\n' bench size cols time throughput "peak RSS"
+
+# --- Compile throughput: wizuallc (parse, optimize, analyze, generate C) ---
+for n in $STATEMENTS; do
+    # n statements over 50 vectors and 50 scalars: initializations, then a mix
+    # of scalar arithmetic, element-wise vector arithmetic and reductions
+    awk -v n="$n" 'BEGIN {
+        for (i = 0; i < n; i++) {
+            k = i % 50; j = (i * 7 + 1) % 50
+            if (i < 50) printf "v%d = [%d, 2, 3, 4];\n", k, i
+            else if (i < 100) printf "s%d = %d;\n", k, i
+            else if (i % 3 == 0) printf "s%d = s%d * 1.5 + %d;\n", k, j, i
+            else if (i % 3 == 1) printf "v%d = v%d * 2 + v%d - s%d;\n", k, j, k, j
+            else printf "s%d = mean(v%d) + s%d;\n", k, j, k
+        }
+    }' > "$TMP/prog.wzu"
+    measure "$WIZUALLC" "$TMP/prog.wzu" "$TMP/prog.c"
+    record compile "$n" 0 "$(wc -c < "$TMP/prog.wzu")" "$secs" "$n" stmt/s "$rss"
+done
+
+# --- Load, streaming and reduction throughput of generated programs ---
+for r in $ROWS; do
+    for c in $COLS; do
+        if [ "$c" -gt 1 ] && [ $((r * c)) -gt "$MAX_VALUES" ]; then continue; fi
+        f=d${r}x$c # File names are identifiers in WizuAll
+        "$BENCHTOOL" gen-data "$r" "$c" "$TMP/$f" || exit 1
+        bytes=$(wc -c < "$TMP/$f")
+
+        # Every column loaded in one batched scan, each used once
+        awk -v f="$f" -v c="$c" 'BEGIN {
+            printf "%s = 0;\n", f
+            for (i = 0; i < c; i++) printf "c%d = load_vector(%s, %d);\n", i, f, i
+            printf "t = 0"; for (i = 0; i < c; i++) printf " + sum(c%d)", i; printf ";\n"
+        }' > "$TMP/load.wzu"
+        build "$TMP/load.wzu" "$TMP/load" --no-streaming
+        measure "$TMP/load"
+        record load "$r" "$c" "$bytes" "$secs" "$bytes" MB/s "$rss"
+        build "$TMP/load.wzu" "$TMP/stream"
+        measure "$TMP/stream"
+        record stream "$r" "$c" "$bytes" "$secs" "$bytes" MB/s "$rss"
+
+        if [ "$c" -eq 1 ]; then
+            # Loop of 4 reductions, timed against the same load without it;
+            # about 4 GB of doubles are read whatever the row count
+            reps=$(awk -v r="$r" 'BEGIN { n = int(1e9 / (r * 8)); print (n < 1 ? 1 : n) }')
+            { cat "$TMP/load.wzu"; printf 'k = %d;\nwhile (k) {\n  t = t + sum(c0) + min_val(c0) + max_val(c0) + mean(c0);\n  k = k - 1;\n}\n' "$reps"; } > "$TMP/reduce.wzu"
+            build "$TMP/reduce.wzu" "$TMP/reduce" --no-streaming
+            measure "$TMP/load"
+            base=$secs
+            measure "$TMP/reduce"
+            elapsed=$(awk -v a="$secs" -v b="$base" 'BEGIN { printf "%.6f", a - b }')
+            record reduce "$r" 1 $((r * 8)) "$elapsed" "$((reps * 4 * r * 8))" GB/s "$rss"
+        fi
+        rm -f "$TMP/$f"
+    done
+done
+echo "Results written to $OUT"
+
+# --- Comparison with a baseline ---
+if [ -n "$BENCH_BASELINE" ]; then
+    awk -v tol="$TOLERANCE" '
+        function field(line, name,    m) {
+            if (match(line, "\"" name "\":\"?[^,\"}]*")) {
+                m = substr(line, RSTART, RLENGTH); sub(/^[^:]*:"?/, "", m); return m
+            }
+            return ""
+        }
+        field($0, "bench") == "meta" { next }
+        {
+            key = field($0, "bench") " " field($0, "size") " " field($0, "cols")
+            if (FNR == NR) { base_t[key] = field($0, "throughput"); base_rss[key] = field($0, "peak_rss_kb"); next }
+            if (!(key in base_t)) next
+            t = field($0, "throughput"); rss = field($0, "peak_rss_kb")
+            dt = base_t[key] > 0 ? (t - base_t[key]) * 100 / base_t[key] : 0
+            drss = base_rss[key] > 0 ? (rss - base_rss[key]) * 100 / base_rss[key] : 0
+            flag = (dt < -tol || drss > tol) ? "  REGRESSION" : ""
+            if (flag != "") regressions++
+            printf "%-26s throughput %+7.1f%%  peak RSS %+7.1f%%%s\n", key, dt, drss, flag
+        }
+        END {
+            if (regressions) { printf "%d regression(s) beyond %s%%\n", regressions, tol; exit 1 }
+            print "No regressions"
+        }' "$BENCH_BASELINE" "$OUT"
+fi
@@ -0,0 +1,98 @@
+// Helpers for bench/bench.sh that the shell cannot do quickly or portably.
+//
+// usage: benchtool gen-data ROWS COLS FILE   Writes ROWS lines of COLS random
+//                                            space-separated numbers (deterministic)
+//        benchtool measure OUT CMD [ARGS...] Runs CMD and writes "<seconds> <peak RSS KiB>"
+//                                            to OUT; exits with CMD's status
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static int genData(long rows, int cols, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+    uint64_t state = 0x9E3779B97F4A7C15ull; // xorshift64*: the same file on every run
+    for (long r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            uint64_t x = state * 0x2545F4914F6CDD1Dull;
+            // Fixed-point value in [-5000, 5000) with 3 decimals, formatted by hand
+            long v = (long)(x % 10000000ull) - 5000000;
+            char text[32], *p = text + sizeof(text);
+            unsigned long a = (unsigned long)(v < 0 ? -v : v);
+            for (int d = 0; d < 3; d++) {
+                *--p = (char)('0' + a % 10);
+                a /= 10;
+            }
+            *--p = '.';
+            do {
+                *--p = (char)('0' + a % 10);
+                a /= 10;
+            } while (a);
+            if (v < 0) *--p = '-';
+            if (c) putc(' ', out);
+            fwrite(p, 1, (size_t)(text + sizeof(text) - p), out);
+        }
+        putc('\n', out);
+    }
+    if (fclose(out) != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+static int measure(const char* resultPath, char** argv) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    FILE* result = fopen(resultPath, "w");
+    if (!result) {
+        perror(resultPath);
+        return 1;
+    }
+    fprintf(result, "%.6f %ld\n", seconds, usage.ru_maxrss); // ru_maxrss is in KiB on Linux
+    fclose(result);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && strcmp(argv[1], "gen-data") == 0) {
+        return genData(atol(argv[2]), atoi(argv[3]), argv[4]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "measure") == 0) {
+        return measure(argv[2], argv + 3);
+    }
+    fprintf(stderr, "usage: %s gen-data ROWS COLS FILE | measure OUT CMD [ARGS...]\n", argv[0]);
+    return 2;
+}
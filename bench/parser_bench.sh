@@ -0,0 +1,42 @@
+#!/bin/sh
+# Parser scaling benchmark: compiles generated programs with 250k/500k/1M
+# statements and vector literals with 250k/500k/1M elements, and reports the
+# time per item. Linear parsing shows a roughly constant ns/item column.
+#
+# usage: bench/parser_bench.sh [path/to/wizuallc]   (default ./wizuallc)
+
+WIZUALLC=${1:-./wizuallc}
+SIZES=${BENCH_SIZES:-"250000 500000 1000000"}
+TMP=$(mktemp -d "${TMPDIR:-/tmp}/wizuall-bench.XXXXXX") || exit 1
+trap 'rm -rf "$TMP"' EXIT INT TERM
+
+if [ ! -x "$WIZUALLC" ]; then
+    echo "wizuallc not found at $WIZUALLC (run make first)" >&2
+    exit 1
+fi
+
+now_ns() { date +%s%N; }
+
+# run <label> <items> <source>
+run() {
+    start=$(now_ns)
+    if ! "$WIZUALLC" "$3" "$TMP/out.c" > /dev/null 2> "$TMP/err.log"; then
+        echo "$1: wizuallc failed" >&2
+        cat "$TMP/err.log" >&2
+        exit 1
+    fi
+    end=$(now_ns)
+    awk -v l="$1" -v n="$2" -v t="$((end - start))" \
+        'BEGIN { printf "%-10s %9d items %9.3f s %8.1f ns/item\n", l, n, t / 1e9, t / n }'
+}
+
+for n in $SIZES; do
+    # n statements over a rolling set of 1000 variables
+    awk -v n="$n" 'BEGIN { for (i = 0; i < n; i++) printf "v%d = v%d + %d * 2;\n", i % 1000, (i + 1) % 1000, i }' > "$TMP/stmts.wzu"
+    run statements "$n" "$TMP/stmts.wzu"
+done
+for n in $SIZES; do
+    # One vector literal with n elements
+    awk -v n="$n" 'BEGIN { printf "v = ["; for (i = 0; i < n; i++) printf "%s%d", (i ? ", " : ""), i; printf "];\n" }' > "$TMP/literal.wzu"
+    run literal "$n" "$TMP/literal.wzu"
+done
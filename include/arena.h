@@ -0,0 +1,39 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h> // For size_t
+
+// Bump allocator: memory is carved out of large chunks and released all at
+// once by arena_destroy. There is no per-allocation free.
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk *head;  // Chunk currently allocated from (older chunks follow)
+    size_t chunk_size; // Size of new chunks (0 = ARENA_DEFAULT_CHUNK)
+    size_t allocations; // Statistics: number of arena_alloc calls
+    size_t bytes;       // Statistics: bytes handed out
+} Arena;
+
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+// Arena for everything living as long as one compilation: AST nodes, vector
+// literal element arrays, symbols and interned identifier names
+extern Arena compileArena;
+
+/**
+ * @brief Allocates size bytes (aligned for any type) from the arena.
+ * Exits on allocation failure, like the other compiler allocators.
+ */
+void* arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief Copies a string into the arena.
+ */
+char* arena_strdup(Arena *arena, const char *s);
+
+/**
+ * @brief Frees every chunk of the arena; all its allocations become invalid.
+ */
+void arena_destroy(Arena *arena);
+
+#endif // ARENA_H
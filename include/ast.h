@@ -17,7 +17,9 @@ typedef enum {
     NODE_ASSIGN,   // Assignment statement
     NODE_IF,       // If statement
     NODE_WHILE,    // While statement
-    NODE_FUNC_CALL // Function call
+    NODE_FUNC_CALL, // Function call
+    NODE_INDEX,    // Element read v[i]
+    NODE_INDEX_ASSIGN // Element assignment v[i] = value
     // Add other types later (e.g., NODE_FUNC_CALL, NODE_IF)
 } NodeType;
 
@@ -28,6 +30,13 @@ typedef enum {
     OP_STAR,
     OP_MINUS,
     OP_DIV,
+    // Comparisons (1 if true, 0 if false)
+    OP_LT,
+    OP_GT,
+    OP_LE,
+    OP_GE,
+    OP_EQ,
+    OP_NE,
     // Unary
     OP_UMINUS // Unary minus
     // Add other operators later
@@ -38,6 +47,10 @@ struct Node {
     NodeType type;
     Node *next; // For lists of statements/expressions
     int lineno; // Store line number for errors/debugging
+    // Expression shape, filled in by the semantic pass (semantic.c)
+    int isVector;    // Evaluates to a Vector
+    long length;     // Vector length if statically known, -1 otherwise
+    int lengthClass; // Nonzero: equal to the length of every vector of the same class
 
     union {
         // NODE_NUM
@@ -55,16 +68,17 @@ struct Node {
         } unaryOp;
         // NODE_ID
         struct {
-            char *sval; // Name of the identifier
+            const char *sval; // Name of the identifier (interned)
         } id;
         // NODE_VEC
         struct {
-            Node **elements; // Dynamically allocated array of element nodes
+            Node **elements; // Arena-allocated array of element nodes
             size_t count;    // Number of elements
+            size_t capacity; // Allocated length of elements
         } vec;
         // NODE_ASSIGN
         struct {
-            char *name;    // Name of the variable being assigned to
+            const char *name; // Name of the variable being assigned to (interned)
             Node *value;   // AST subtree for the value being assigned
         } assignOp;
         // NODE_IF
@@ -80,27 +94,40 @@ struct Node {
         } whileStmt;
         // NODE_FUNC_CALL
         struct {
-            char *name;      // Function name
+            const char *name; // Function name (interned)
             Node *args;      // Head of argument list (linked via 'next')
         } funcCall;
+        // NODE_INDEX, NODE_INDEX_ASSIGN
+        struct {
+            const char *name; // Vector variable (interned)
+            Node *index;
+            Node *value;      // Stored value (NODE_INDEX_ASSIGN only)
+            int inBounds;     // Semantic pass: index proven within the vector, no run-time check
+        } index;
     } data;
 };
 
 // --- Function Prototypes for ast.c ---
+// Identifier strings passed to the constructors must be interned (symtab_intern)
+// and are stored without copying.
 
 Node* newNodeNum(int lineno, double val);
 Node* newNodeBinaryOp(int lineno, OpType op, Node* left, Node* right);
 Node* newNodeUnaryOp(int lineno, OpType op, Node* operand);
-Node* newNodeID(int lineno, char* sval);
+Node* newNodeID(int lineno, const char* sval);
 Node* newNodeVec(int lineno, Node* firstElement); // Initially create with one element
 Node* appendToVec(Node* vecNode, Node* element); // Helper to add elements during parsing
-Node* newNodeAssign(int lineno, char* name, Node* value);
+Node* newNodeAssign(int lineno, const char* name, Node* value);
 Node* newNodeIf(int lineno, Node* condition, Node* then_branch, Node* else_branch);
 Node* newNodeWhile(int lineno, Node* condition, Node* body);
-Node* newNodeFuncCall(int lineno, char* name, Node* args);
+Node* newNodeFuncCall(int lineno, const char* name, Node* args);
+Node* newNodeIndex(int lineno, const char* name, Node* index);
+Node* newNodeIndexAssign(int lineno, const char* name, Node* index, Node* value);
 
 void printAST(Node* node, int indent);
-void freeAST(Node* node);
+// Nodes created so far (wizuallc --stats)
+extern size_t ast_node_count;
+// Nodes live in compileArena (see arena.h) and are released with it; there is no per-tree free.
 
 
 #endif // AST_H 
\ No newline at end of file
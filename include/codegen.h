@@ -5,13 +5,32 @@
 #include "symtab.h"
 #include <stdio.h> 
 
+// Options controlling the generated program (set from wizuallc command-line flags)
+typedef struct {
+    int enableCache;    // Binary columnar cache for load_vector inputs (--cache / --no-cache)
+    int compensatedSum; // Kahan-compensated sums in reductions (--compensated-sum)
+    int parallel;       // OpenMP-parallel vector operations and reductions (--parallel)
+    int streamReductions; // Stream loads that are only reduced instead of materializing them (--no-streaming)
+    int plotPoints;     // plot_xy decimates longer series to this many points; 0 = never (--plot-points=N)
+    int plotDecimate;   // Decimation method: 0 = per-bucket min/max, 1 = LTTB (--plot-decimate=minmax|lttb)
+    int inlineRuntime;  // Embed the runtime source instead of linking libwizurt (--inline-runtime)
+    int profile;        // Per-line time, allocation and read probes around every statement (--profile)
+    const char* sourceName; // Program file name, shown in the profile report
+} CodegenOptions;
+
+/**
+ * @brief Fills in the default code generation options.
+ */
+void initCodegenOptions(CodegenOptions* options);
+
 /**
  * @brief Generates C code from the Abstract Syntax Tree.
  * 
  * @param astRoot The root of the AST (likely the head of a statement list).
  * @param outfile The output file stream to write the C code to.
+ * @param options Code generation options (NULL for defaults).
  */
-void generateCode(Node* astRoot, FILE* outfile);
+void generateCode(Node* astRoot, FILE* outfile, const CodegenOptions* options);
 
 
 #endif // CODEGEN_H 
\ No newline at end of file
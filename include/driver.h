@@ -0,0 +1,63 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <limits.h>  // For PATH_MAX
+#include "ast.h"
+#include "codegen.h" // For CodegenOptions
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+// Native build settings (wizuallc --build / --exec)
+typedef struct {
+    int exec;               // Run the executable instead of copying it to outputPath (--exec)
+    const char* profile;    // Optimization profile name (--opt=debug|release|fast|native)
+    const char* extraFlags; // Extra C compiler flags, space separated (--cflags=...)
+    int optimize;           // AST optimization pass enabled (part of the cache key)
+} NativeOptions;
+
+// A native build: its cache key and where the executable lives
+typedef struct {
+    char key[65];            // SHA-256 of everything the executable depends on
+    char exePath[PATH_MAX];  // Cached executable
+    int cached;              // 1 if exePath already exists (no codegen or C compile needed)
+    size_t generatedBytes;   // Size of the generated C (set by nativeCompile)
+} NativeBuild;
+
+/**
+ * @brief Fills in the default native build settings (release profile, no extra flags).
+ */
+void initNativeOptions(NativeOptions* native);
+
+/**
+ * @brief Computes the cache key of a native build and looks it up.
+ *
+ * The key hashes the program source, the code generation options, the C
+ * compiler command, profile and flags, the compiler's --version output, the
+ * wizuallc build and the runtime library, so any change to them rebuilds.
+ * The cache lives in $WIZUALL_CACHE_DIR, else $XDG_CACHE_HOME/wizuall, else
+ * ~/.cache/wizuall. The compiler is $CC, else cc.
+ *
+ * @param sourcePath The .wzu program (a file: standard input cannot be keyed).
+ * @param options Code generation options; inlineRuntime is set when libwizurt
+ *        is not installed next to wizuallc.
+ * @return 0 on success, 1 on error (reported on stderr).
+ */
+int nativePrepare(const char* sourcePath, CodegenOptions* options, const NativeOptions* native, NativeBuild* build);
+
+/**
+ * @brief Generates C for the analyzed AST and compiles it into the cache.
+ * @return 0 on success, 1 if the C compiler failed.
+ */
+int nativeCompile(Node* astRoot, const CodegenOptions* options, const NativeOptions* native, NativeBuild* build);
+
+/**
+ * @brief Runs the cached executable (--exec; does not return on success) or
+ * copies it to outputPath (--build).
+ * @return The exit status for wizuallc.
+ */
+int nativeFinish(const NativeBuild* build, const NativeOptions* native, const char* outputPath);
+
+
+#endif // DRIVER_H
@@ -0,0 +1,19 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "ast.h"
+
+/**
+ * @brief Optimizes the program's AST in place, between parsing and code generation.
+ *
+ * Folds constant subexpressions, propagates scalar variables holding known
+ * constants through straight-line code, and applies the exact identity rules
+ * x*1, 1*x, x/1, x-0 and -(-x). Every rewrite preserves the IEEE double result
+ * bit for bit.
+ *
+ * @param astRoot The root of the AST (head of the top-level statement list).
+ */
+void optimizeAST(Node* astRoot);
+
+
+#endif // OPTIMIZE_H
@@ -0,0 +1,24 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stdio.h>
+#include "codegen.h" // For CodegenOptions
+
+/**
+ * @brief Emits the runtime support code of a generated program: the include
+ * of the libwizurt header (runtime/wizurt.h), or the whole runtime source
+ * when options->inlineRuntime is set.
+ *
+ * @param outfile The output file stream to write the C code to.
+ * @param options Options selecting runtime features (e.g. --parallel).
+ */
+void emitRuntime(FILE* outfile, const CodegenOptions* options);
+
+/**
+ * @brief Emits the statements at the start of main() that pass the
+ * wizuallc options (cache, compensated sums, plot decimation, ...) to the runtime.
+ */
+void emitRuntimeConfig(FILE* outfile, const CodegenOptions* options);
+
+
+#endif // RUNTIME_H
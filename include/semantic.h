@@ -0,0 +1,27 @@
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include "ast.h"
+
+/**
+ * @brief Infers the type of every variable and the shape of every expression.
+ *
+ * Variables become TYPE_SCALAR or TYPE_VECTOR. Each expression node records
+ * whether it is a vector and, where it can be proven, its length or a length
+ * class shared with other vectors. Errors that would otherwise produce
+ * broken C (a scalar assigned to a vector variable, vector conditions,
+ * mismatched literal lengths, bad built-in arguments) are reported here.
+ * Runs after optimizeAST and before generateCode, which relies on the results.
+ *
+ * @param astRoot The root of the AST (head of the top-level statement list).
+ * @return The number of errors reported (0 if the program can be compiled).
+ */
+int analyzeSemantics(Node* astRoot);
+
+/**
+ * @brief Returns 1 if the two vector expressions are proven to have equal lengths.
+ */
+int sameVectorLength(const Node* a, const Node* b);
+
+
+#endif // SEMANTIC_H
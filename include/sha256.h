@@ -0,0 +1,23 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h> // For size_t
+#include <stdint.h>
+
+// SHA-256 (FIPS 180-4), used for the native build cache keys
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;         // Bytes hashed so far
+    unsigned char block[64]; // Pending partial block
+    size_t used;             // Bytes in block[]
+} Sha256;
+
+void sha256_init(Sha256 *ctx);
+void sha256_update(Sha256 *ctx, const void *data, size_t size);
+
+/**
+ * @brief Finishes the hash and writes it as 64 lowercase hex digits plus a NUL.
+ */
+void sha256_hex(Sha256 *ctx, char out[65]);
+
+#endif // SHA256_H
@@ -0,0 +1,43 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stddef.h> // For size_t
+
+// Compiler statistics (wizuallc --stats): wall time and memory per phase, and
+// the size of the program at each stage
+
+// One timed phase of the compilation
+typedef struct {
+    const char* name;
+    double seconds;
+    size_t arenaBytes; // compileArena growth during the phase
+    size_t heapBytes;  // malloc'd bytes in use at the end of the phase (0 if unknown)
+    long peakRssKb;    // Process peak RSS at the end of the phase
+} PhaseStats;
+
+// Program sizes, filled in by the driver as the compilation goes
+typedef struct {
+    size_t sourceBytes, sourceLines, tokens;
+    size_t nodes, symbols;
+    size_t outputBytes; // Generated C (0 if none was written)
+} CompileCounts;
+
+/**
+ * @brief Starts timing a phase; phases do not nest.
+ */
+void stats_phase_begin(const char* name);
+
+/**
+ * @brief Ends the current phase and returns its record (valid until stats_report).
+ */
+PhaseStats* stats_phase_end(void);
+
+/**
+ * @brief Prints the phase table and the program sizes (counts may be NULL
+ * when nothing was compiled, e.g. a native build cache hit).
+ */
+void stats_report(FILE* out, const CompileCounts* counts);
+
+
+#endif // STATS_H
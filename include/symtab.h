@@ -13,23 +13,51 @@ typedef enum {
 
 // Structure for a single symbol
 typedef struct Symbol {
-    char *name;      // Symbol name (variable identifier)
+    const char *name; // Symbol name (variable identifier), interned
     DataType type;   // Data type (scalar, vector, etc.)
     int declared_lineno; // Line number where declared/first assigned
-    // Add more info later: scope level, value/pointer (for interpreter), etc.
-    struct Symbol *next; // Pointer for linked list implementation
+    int streamed;    // Vector only loaded and reduced: kept as running statistics (set by codegen)
+    int const_known;    // Optimizer: holds const_value at the current program point
+    double const_value;
+    long length;        // Semantic pass: vector length at the current program point (-1 unknown);
+                        // for a scalar, a vector length it is known to equal
+    int length_class;   // Semantic pass: length class at the current program point (0 none), as above
+    int nonneg;         // Semantic pass: scalar known to be a number >= 0 (never NaN)
+    long fixed_length;  // Length of every value ever assigned to the vector, -1 if not fixed
+    int live_slot;      // Codegen: bit of the heap vector in liveness sets, -1 if not tracked
+    int vm_reg;         // --run VM: the variable's scalar or vector register, -1 if not assigned
+    int scope_level; // Scope the symbol was declared in (0 = global)
+    struct Symbol *shadowed;   // Same-named symbol of an enclosing scope hidden by this one
+    struct Symbol *scope_next; // Next symbol declared in the same scope (scope exit)
+    struct Symbol *next; // Every symbol ever declared, newest first (declaration order for codegen)
 } Symbol;
 
-// Symbol Table structure (simple linked list head)
+// Interned identifier: one entry per distinct name, bound to the innermost
+// visible symbol of that name
+typedef struct {
+    const char *name; // Allocated in compileArena
+    unsigned int hash;
+    Symbol *binding; // NULL if no symbol of this name is in scope
+} NameEntry;
+
+// Symbol Table structure: an open-addressing hash table (linear probing) of
+// interned names, plus the declaration-order list and the scope stack
 typedef struct {
     Symbol *head;
     int count;
-    // Add fields for hash table later if needed
+    NameEntry *names;    // Hash table of interned names (capacity is a power of two)
+    size_t name_capacity;
+    size_t name_count;
+    Symbol **scopes;     // scopes[level]: symbols declared in that open scope
+    int scope_level;     // Innermost open scope (0 = global)
+    int scope_capacity;
 } SymTab;
 
 // --- Global Symbol Table (simplicity for now) ---
 // Note: A better design passes the table around or uses context struct
 extern SymTab *globalSymTab;
+// Print symbol table debug messages on stdout (cleared by wizuallc --run)
+extern int symtab_trace;
 
 // --- Function Prototypes for symtab.c ---
 
@@ -39,7 +67,7 @@ extern SymTab *globalSymTab;
 void symtab_init();
 
 /**
- * @brief Looks up a symbol by name in the global table.
+ * @brief Looks up the innermost visible symbol with the given name.
  * @param name The name of the symbol to find.
  * @return Pointer to the Symbol structure if found, NULL otherwise.
  */
@@ -47,8 +75,8 @@ Symbol* symtab_lookup(const char *name);
 
 /**
  * @brief Inserts a new symbol or updates an existing one.
- * If the symbol exists, its type might be updated (e.g., from undefined).
- * If it doesn't exist, it's added to the table.
+ * If a symbol of this name is visible, its type might be updated (e.g., from undefined).
+ * If not, it's declared in the current scope.
  * @param name The name of the symbol.
  * @param type The data type of the symbol.
  * @param lineno The line number for the declaration/assignment.
@@ -57,7 +85,33 @@ Symbol* symtab_lookup(const char *name);
 Symbol* symtab_insert(const char *name, DataType type, int lineno);
 
 /**
- * @brief Frees all memory associated with the global symbol table.
+ * @brief Declares a new symbol in the current scope, shadowing any symbol of
+ * the same name from an enclosing scope.
+ * @return The existing symbol if the name is already declared in this scope.
+ */
+Symbol* symtab_declare(const char *name, DataType type, int lineno);
+
+/**
+ * @brief Returns the table's canonical copy of a name (adding it if new).
+ * Equal names always yield the same pointer, valid until compileArena is destroyed.
+ */
+const char* symtab_intern(const char *name);
+
+/**
+ * @brief Opens a nested scope; symbols declared until the matching
+ * symtab_exit_scope are hidden again when it closes.
+ */
+void symtab_enter_scope();
+
+/**
+ * @brief Closes the innermost scope, restoring any shadowed symbols.
+ * Symbols of the closed scope stay in the declaration-order list.
+ */
+void symtab_exit_scope();
+
+/**
+ * @brief Frees the global symbol table's lookup structures. Symbols and
+ * interned names are allocated in compileArena and freed with it.
  */
 void symtab_destroy();
 
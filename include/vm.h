@@ -0,0 +1,22 @@
+#ifndef VM_H
+#define VM_H
+
+#include "ast.h"
+#include "codegen.h" // For CodegenOptions
+
+/**
+ * @brief Runs the program in process (wizuallc --run) instead of generating C.
+ *
+ * The analyzed AST is lowered into register-based bytecode and executed by
+ * an interpreter loop. Loading, reductions, printing and plotting call the
+ * same libwizurt helpers as generated programs, so output matches the
+ * compiled program's.
+ *
+ * @param astRoot The root of the AST, after analyzeSemantics.
+ * @param options Runtime options (cache, compensated sums, plot decimation, ...).
+ * @return The exit status: 0 on success, 1 if the program uses a feature the VM lacks.
+ */
+int runProgram(Node* astRoot, const CodegenOptions* options);
+
+
+#endif // VM_H
@@ -0,0 +1,1525 @@
+// WizuAll runtime library (libwizurt).
+// Built once by `make libwizurt` and linked into every generated program;
+// `wizuallc --inline-runtime` embeds this file in the output instead.
+
+#define _GNU_SOURCE // For mmap/madvise with strict -std flags
+#include "wizurt.h"
+#include <errno.h>
+#include <fcntl.h>    // For open
+#include <unistd.h>   // For read, close
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <signal.h>   // For SIGPIPE handling on the gnuplot pipe
+#include <pthread.h>  // For the multi-threaded loader (link with -pthread)
+#include <time.h>     // For clock_gettime (profiling)
+#include <stdint.h>   // For the number formatter's 64-bit arithmetic
+
+// --- Configuration (see wizurt.h) ---
+WZ_DEF int wz_cache_enabled = 0;
+WZ_DEF int wz_compensated_sum = 0;
+WZ_DEF int wz_parallel = 0;
+WZ_DEF size_t wz_plot_points = 4000;
+WZ_DEF int wz_plot_decimate = 0;
+
+// --- Profiling (wizuallc --profile) ---
+// Per source line: statement executions, wall time including and excluding
+// nested statements, vector bytes allocated and input bytes read. Probes form
+// a stack through WzProbe.parent; allocations and reads are charged to the
+// line of the innermost open probe. Without wz_profile_start, every hook is a
+// single NULL check.
+
+typedef struct {
+    unsigned long long count, total_ns, self_ns, alloc_bytes, read_bytes;
+} ProfileLine;
+
+static ProfileLine* wz_profile_lines = NULL; // Indexed by line, 0..wz_profile_line_count
+static int wz_profile_line_count = 0;
+static WzProbe* wz_profile_current = NULL;    // Innermost open probe
+static const char* wz_profile_source = "";
+static unsigned long long wz_profile_started = 0;
+
+static unsigned long long profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+static ProfileLine* profile_current_line(void) {
+    return &wz_profile_lines[wz_profile_current ? wz_profile_current->line : 0];
+}
+
+static void profile_alloc(size_t bytes) {
+    if (wz_profile_lines) profile_current_line()->alloc_bytes += bytes;
+}
+
+static void profile_read(size_t bytes) {
+    if (wz_profile_lines) profile_current_line()->read_bytes += bytes;
+}
+
+// Writes the report to $WIZUALL_PROFILE if set, else to stderr
+static void profile_report(void) {
+    fflush(stdout); // Program output first
+    const char* path = getenv("WIZUALL_PROFILE");
+    FILE* out = (path && *path) ? fopen(path, "w") : stderr;
+    if (!out) { fprintf(stderr, "Cannot write profile to %s\n", path); out = stderr; }
+    double elapsed = (double)(profile_now() - wz_profile_started) / 1e9;
+    fprintf(out, "--- WizuAll profile: %s (%.6f s) ---\n", wz_profile_source, elapsed);
+    fprintf(out, "%6s %12s %12s %12s %7s %14s %14s\n", "line", "count", "total ms", "self ms", "self %",
+            "alloc bytes", "read bytes");
+    for (int i = 0; i <= wz_profile_line_count; ++i) {
+        const ProfileLine* l = &wz_profile_lines[i];
+        if (!l->count && !l->alloc_bytes && !l->read_bytes) continue;
+        fprintf(out, "%6d %12llu %12.3f %12.3f %6.1f%% %14llu %14llu\n", i, l->count, (double)l->total_ns / 1e6,
+                (double)l->self_ns / 1e6, elapsed > 0 ? (double)l->self_ns / 1e9 * 100.0 / elapsed : 0.0,
+                l->alloc_bytes, l->read_bytes);
+    }
+    if (out != stderr) fclose(out);
+}
+
+WZ_DEF void wz_profile_start(const char* source, int lines) {
+    wz_profile_lines = (ProfileLine*)calloc((size_t)lines + 1, sizeof(ProfileLine));
+    if (!wz_profile_lines) { fprintf(stderr, "Profile allocation failed\n"); exit(1); }
+    wz_profile_line_count = lines;
+    wz_profile_source = source;
+    wz_profile_started = profile_now();
+    atexit(profile_report); // Also reports programs stopped by a runtime error
+}
+
+WZ_DEF void wz_probe_enter(WzProbe* p, int line) {
+    p->parent = wz_profile_current;
+    p->line = (line >= 0 && line <= wz_profile_line_count) ? line : 0;
+    p->nested = 0;
+    wz_profile_current = p;
+    p->start = profile_now();
+}
+
+WZ_DEF void wz_probe_exit(WzProbe* p) {
+    unsigned long long elapsed = profile_now() - p->start;
+    ProfileLine* l = &wz_profile_lines[p->line];
+    l->count++;
+    l->total_ns += elapsed;
+    l->self_ns += elapsed - p->nested;
+    if (p->parent) p->parent->nested += elapsed;
+    wz_profile_current = p->parent;
+}
+
+// --- Vectors ---
+// Pool of released buffers, reused by alloc_vector for vectors of the same size.
+// Bounded in count and bytes, so a loop cannot grow it without limit.
+#define WZ_POOL_SLOTS 8
+#define WZ_POOL_MAX_BYTES ((size_t)64 << 20)
+static struct { double* data; size_t size; } wz_pool[WZ_POOL_SLOTS]; // Oldest first
+static int wz_pool_count = 0;
+static size_t wz_pool_bytes = 0;
+
+WZ_DEF Vector alloc_vector(size_t size) {
+    Vector v; v.size = size; v.owned = 1;
+    profile_alloc(size * sizeof(double));
+    for (int i = wz_pool_count - 1; i >= 0; --i) {
+        if (wz_pool[i].size != size) continue;
+        v.data = wz_pool[i].data;
+        wz_pool_bytes -= size * sizeof(double);
+        memmove(&wz_pool[i], &wz_pool[i + 1], (size_t)(wz_pool_count - i - 1) * sizeof(wz_pool[0]));
+        wz_pool_count--;
+        return v;
+    }
+    v.data = (double*)malloc(size * sizeof(double));
+    if (!v.data && size > 0) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+    return v;
+}
+
+WZ_DEF Vector create_vector(size_t size) {
+    Vector v = alloc_vector(size);
+    for(size_t i=0; i<size; ++i) v.data[i] = 0.0; /* Initialize */ 
+    return v;
+}
+
+WZ_DEF void vector_size_mismatch(int line, const char* name, size_t got, size_t expected) {
+    fprintf(stderr, "Runtime Error line %d: vector '%s' has size %zu, expected %zu\n", line, name, got, expected);
+    exit(1);
+}
+
+WZ_DEF size_t vector_length_arg(int line, double n) {
+    if (!(n >= 0 && n <= 1e15 && n == floor(n))) {
+        char text[WZ_DOUBLE_CHARS];
+        wz_format_double(n, text);
+        fprintf(stderr, "Runtime Error line %d: create_vector length %s is not a non-negative integer\n", line, text);
+        exit(1);
+    }
+    return (size_t)n;
+}
+
+WZ_DEF void make_vector_writable(Vector* v) {
+    if (v->owned) return;
+    Vector r = alloc_vector(v->size);
+    if (v->size > 0) memcpy(r.data, v->data, v->size * sizeof(double));
+    *v = r; // The view's memory is not ours to release
+}
+
+WZ_DEF void vector_index_error(int line, const char* name, double index, size_t size) {
+    char text[WZ_DOUBLE_CHARS];
+    wz_format_double(index, text);
+    fprintf(stderr, "Runtime Error line %d: index %s is out of bounds for vector '%s' of size %zu\n", line, text, name, size);
+    exit(1);
+}
+
+WZ_DEF void free_vector(Vector v) {
+    if (v.owned) free(v.data);
+}
+
+WZ_DEF void release_vector(Vector* v) {
+    size_t bytes = v->size * sizeof(double);
+    if (v->owned && v->size > 0 && bytes <= WZ_POOL_MAX_BYTES) {
+        while (wz_pool_count == WZ_POOL_SLOTS || wz_pool_bytes + bytes > WZ_POOL_MAX_BYTES) {
+            free(wz_pool[0].data); // Evict the oldest
+            wz_pool_bytes -= wz_pool[0].size * sizeof(double);
+            memmove(&wz_pool[0], &wz_pool[1], (size_t)(--wz_pool_count) * sizeof(wz_pool[0]));
+        }
+        wz_pool[wz_pool_count].data = v->data; wz_pool[wz_pool_count].size = v->size;
+        wz_pool_count++; wz_pool_bytes += bytes;
+    } else {
+        free_vector(*v);
+    }
+    v->data = NULL; v->size = 0; v->owned = 0;
+}
+
+WZ_DEF Vector reuse_vector(const Vector* v, size_t n) {
+    if (v->owned && v->size == n) return *v;
+    return alloc_vector(n);
+}
+
+WZ_DEF void replace_vector(Vector* v, Vector r) {
+    if (r.data != v->data) release_vector(v);
+    *v = r;
+}
+
+// --- Number output ---
+// Doubles are printed with the fewest digits that read back as the same value
+// (shortest round trip, Ryu), laid out like %.17g. Tables: 5^i split into
+// 128-bit words every 26 powers, plus 2-bit corrections for the powers between
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 wz_u128;
+
+static const uint64_t WZ_POW5_TABLE[26] = {
+    1u, 5u, 25u, 125u,
+    625u, 3125u, 15625u, 78125u,
+    390625u, 1953125u, 9765625u, 48828125u,
+    244140625u, 1220703125u, 6103515625u, 30517578125u,
+    152587890625u, 762939453125u, 3814697265625u, 19073486328125u,
+    95367431640625u, 476837158203125u, 2384185791015625u, 11920928955078125u,
+    59604644775390625u, 298023223876953125u,
+};
+static const uint64_t WZ_POW5_SPLIT2[13][2] = {
+    { 0u, 1152921504606846976u },
+    { 0u, 1490116119384765625u },
+    { 1032610780636961552u, 1925929944387235853u },
+    { 7910200175544436838u, 1244603055572228341u },
+    { 16941905809032713930u, 1608611746708759036u },
+    { 13024893955298202172u, 2079081953128979843u },
+    { 6607496772837067824u, 1343575221513417750u },
+    { 17332926989895652603u, 1736530273035216783u },
+    { 13037379183483547984u, 2244412773384604712u },
+    { 1605989338741628675u, 1450417759929778918u },
+    { 9630225068416591280u, 1874621017369538693u },
+    { 665883850346957067u, 1211445438634777304u },
+    { 14931890668723713708u, 1565756531257009982u },
+};
+static const uint64_t WZ_POW5_INV_SPLIT2[13][2] = {
+    { 1u, 2305843009213693952u },
+    { 5955668970331000884u, 1784059615882449851u },
+    { 8982663654677661702u, 1380349269358112757u },
+    { 7286864317269821294u, 2135987035920910082u },
+    { 7005857020398200553u, 1652639921975621497u },
+    { 17965325103354776697u, 1278668206209430417u },
+    { 8928596168509315048u, 1978643211784836272u },
+    { 10075671573058298858u, 1530901034580419511u },
+    { 597001226353042382u, 1184477304306571148u },
+    { 1527430471115325346u, 1832889850782397517u },
+    { 12533209867169019542u, 1418129833677084982u },
+    { 5577825024675947042u, 2194449627517475473u },
+    { 11006974540203867551u, 1697873161311732311u },
+};
+static const uint32_t WZ_POW5_OFFSETS[21] = {
+    0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u,
+    0x40000000u, 0x59695995u, 0x55545555u, 0x56555515u,
+    0x41150504u, 0x40555410u, 0x44555145u, 0x44504540u,
+    0x45555550u, 0x40004000u, 0x96440440u, 0x55565565u,
+    0x54454045u, 0x40154151u, 0x55559155u, 0x51405555u,
+    0x00000105u,
+};
+static const uint32_t WZ_POW5_INV_OFFSETS[19] = {
+    0x54544554u, 0x04055545u, 0x10041000u, 0x00400414u,
+    0x40010000u, 0x41155555u, 0x00000454u, 0x00010044u,
+    0x40000000u, 0x44000041u, 0x50454450u, 0x55550054u,
+    0x51655554u, 0x40004000u, 0x01000001u, 0x00010500u,
+    0x51515411u, 0x05555554u, 0x00000000u,
+};
+
+static inline int wz_pow5bits(int32_t e) { return (int)(((uint32_t)e * 1217359) >> 19) + 1; } // ceil(log2(5^e)), e > 0
+static inline uint32_t wz_log10_pow2(int32_t e) { return ((uint32_t)e * 78913) >> 18; }      // floor(log10(2^e))
+static inline uint32_t wz_log10_pow5(int32_t e) { return ((uint32_t)e * 732923) >> 20; }     // floor(log10(5^e))
+
+static inline int wz_multiple_of_pow5(uint64_t v, uint32_t p) {
+    uint32_t count = 0;
+    while (v % 5 == 0) { v /= 5; count++; }
+    return count >= p;
+}
+
+// Top 125 bits of 5^i, and 2^(bits(5^i) - 1 + 125) / 5^i + 1, from every 26th power
+static wz_u128 wz_pow5_split(uint32_t i) {
+    uint32_t base = i / 26, base2 = base * 26, offset = i - base2;
+    wz_u128 mul = ((wz_u128)WZ_POW5_SPLIT2[base][1] << 64) | WZ_POW5_SPLIT2[base][0];
+    if (offset == 0) return mul;
+    uint64_t m = WZ_POW5_TABLE[offset];
+    wz_u128 b0 = (wz_u128)m * WZ_POW5_SPLIT2[base][0], b2 = (wz_u128)m * WZ_POW5_SPLIT2[base][1];
+    uint32_t delta = (uint32_t)(wz_pow5bits((int32_t)i) - wz_pow5bits((int32_t)base2));
+    return (b0 >> delta) + (b2 << (64 - delta)) + ((WZ_POW5_OFFSETS[i / 16] >> ((i % 16) << 1)) & 3);
+}
+
+static wz_u128 wz_pow5_inv_split(uint32_t i) {
+    uint32_t base = (i + 25) / 26, base2 = base * 26, offset = base2 - i;
+    wz_u128 mul = ((wz_u128)WZ_POW5_INV_SPLIT2[base][1] << 64) | WZ_POW5_INV_SPLIT2[base][0];
+    if (offset == 0) return mul;
+    uint64_t m = WZ_POW5_TABLE[offset];
+    wz_u128 b0 = (wz_u128)m * (WZ_POW5_INV_SPLIT2[base][0] - 1), b2 = (wz_u128)m * WZ_POW5_INV_SPLIT2[base][1];
+    uint32_t delta = (uint32_t)(wz_pow5bits((int32_t)base2) - wz_pow5bits((int32_t)i));
+    return (b0 >> delta) + (b2 << (64 - delta)) + 1 + ((WZ_POW5_INV_OFFSETS[i / 16] >> ((i % 16) << 1)) & 3);
+}
+
+// (m * mul) >> j for a 125-bit mul and j >= 64
+static inline uint64_t wz_mul_shift(uint64_t m, wz_u128 mul, int32_t j) {
+    wz_u128 b0 = (wz_u128)m * (uint64_t)mul, b2 = (wz_u128)m * (uint64_t)(mul >> 64);
+    return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+}
+
+// Shortest decimal digits that read back as the double (Ryu, Adams 2018): the
+// value is *digits * 10^*exponent. bits has a nonzero exponent or mantissa.
+static void wz_shortest_digits(uint64_t bits, uint64_t* digits, int32_t* exponent) {
+    uint64_t mantissa = bits & ((1ull << 52) - 1);
+    uint32_t biased = (uint32_t)((bits >> 52) & 0x7ff);
+    int32_t e2;
+    uint64_t m2;
+    if (biased == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = mantissa;
+    } else {
+        e2 = (int32_t)biased - 1023 - 52 - 2;
+        m2 = (1ull << 52) | mantissa;
+    }
+    int acceptBounds = (m2 & 1) == 0; // Round-to-even reads the interval ends back as this value
+    // The interval of reals reading back as the value is (mv - 2 + mmShift, mv + 2) * 2^e2 / 4
+    uint64_t mv = 4 * m2;
+    uint32_t mmShift = mantissa != 0 || biased <= 1;
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    int vmIsTrailingZeros = 0, vrIsTrailingZeros = 0;
+    if (e2 >= 0) {
+        uint32_t q = wz_log10_pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        int32_t k = 125 + wz_pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        wz_u128 mul = wz_pow5_inv_split(q);
+        vr = wz_mul_shift(4 * m2, mul, i);
+        vp = wz_mul_shift(4 * m2 + 2, mul, i);
+        vm = wz_mul_shift(4 * m2 - 1 - mmShift, mul, i);
+        if (q <= 21) { // Only then can mv be a multiple of 5^q
+            if (mv % 5 == 0) vrIsTrailingZeros = wz_multiple_of_pow5(mv, q);
+            else if (acceptBounds) vmIsTrailingZeros = wz_multiple_of_pow5(mv - 1 - mmShift, q);
+            else vp -= wz_multiple_of_pow5(mv + 2, q);
+        }
+    } else {
+        uint32_t q = wz_log10_pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = wz_pow5bits(i) - 125;
+        int32_t j = (int32_t)q - k;
+        wz_u128 mul = wz_pow5_split((uint32_t)i);
+        vr = wz_mul_shift(4 * m2, mul, j);
+        vp = wz_mul_shift(4 * m2 + 2, mul, j);
+        vm = wz_mul_shift(4 * m2 - 1 - mmShift, mul, j);
+        if (q <= 1) {
+            vrIsTrailingZeros = 1;
+            if (acceptBounds) vmIsTrailingZeros = mmShift == 1;
+            else --vp;
+        } else if (q < 63) {
+            vrIsTrailingZeros = (mv & ((1ull << q) - 1)) == 0;
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter number
+    int32_t removed = 0;
+    uint64_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) { // Exact ties need the removed digits
+        uint32_t lastRemovedDigit = 0;
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = (uint32_t)(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = (uint32_t)(vr % 10);
+                vr /= 10; vp /= 10; vm /= 10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) lastRemovedDigit = 4; // Round half to even
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        int roundUp = 0;
+        if (vp / 100 > vm / 100) { // Usually several digits go: two divisions at once first
+            roundUp = vr % 100 >= 50;
+            vr /= 100; vp /= 100; vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            roundUp = vr % 10 >= 5;
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+    *digits = output;
+    *exponent = e10 + removed;
+}
+
+#endif // __SIZEOF_INT128__
+
+WZ_DEF int wz_format_double(double value, char* out) {
+#ifndef __SIZEOF_INT128__
+    return snprintf(out, WZ_DOUBLE_CHARS, "%.17g", value); // Round trips, but not the shortest
+#else
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char* p = out;
+    int exponentBits = (int)((bits >> 52) & 0x7ff);
+    if (exponentBits == 0x7ff) {
+        if (bits & ((1ull << 52) - 1)) { memcpy(out, "nan", 4); return 3; }
+        if (bits >> 63) *p++ = '-';
+        memcpy(p, "inf", 4);
+        return (int)(p - out) + 3;
+    }
+    if (bits >> 63) *p++ = '-';
+    if ((bits << 1) == 0) {
+        *p++ = '0';
+        *p = '\0';
+        return (int)(p - out);
+    }
+    uint64_t digits;
+    int32_t e10;
+    wz_shortest_digits(bits, &digits, &e10);
+    char text[20];
+    int n = 0;
+    do { text[19 - n++] = (char)('0' + digits % 10); digits /= 10; } while (digits);
+    const char* d = text + 20 - n;
+    int x = n + e10 - 1; // Exponent of the leading digit
+    if (x < -4 || x >= 17) { // Scientific notation, as %.17g
+        *p++ = d[0];
+        if (n > 1) { *p++ = '.'; memcpy(p, d + 1, (size_t)(n - 1)); p += n - 1; }
+        *p++ = 'e';
+        *p++ = x < 0 ? '-' : '+';
+        int ax = x < 0 ? -x : x;
+        if (ax >= 100) *p++ = (char)('0' + ax / 100);
+        *p++ = (char)('0' + ax / 10 % 10);
+        *p++ = (char)('0' + ax % 10);
+    } else if (x < 0) { // 0.000ddd
+        *p++ = '0'; *p++ = '.';
+        for (int i = -1; i > x; i--) *p++ = '0';
+        memcpy(p, d, (size_t)n); p += n;
+    } else if (x >= n - 1) { // Integral: ddd000
+        memcpy(p, d, (size_t)n); p += n;
+        for (int i = n - 1; i < x; i++) *p++ = '0';
+    } else { // ddd.ddd
+        memcpy(p, d, (size_t)(x + 1)); p += x + 1;
+        *p++ = '.';
+        memcpy(p, d + x + 1, (size_t)(n - x - 1)); p += n - x - 1;
+    }
+    *p = '\0';
+    return (int)(p - out);
+#endif
+}
+
+#define WZ_PRINT_BUFFER (64 * 1024)
+
+// Elements are formatted into a local buffer written to stdout in large blocks
+// (one stdio call per block instead of one per element)
+WZ_DEF void print_vector_runtime(Vector v, const char* name) {
+    char buf[WZ_PRINT_BUFFER];
+    size_t len = 0;
+    printf("Vector %s (size %zu): [", name, v.size);
+    for (size_t i = 0; i < v.size; ++i) {
+        if (len > WZ_PRINT_BUFFER - WZ_DOUBLE_CHARS - 2) {
+            fwrite(buf, 1, len, stdout);
+            len = 0;
+        }
+        if (i > 0) { buf[len++] = ','; buf[len++] = ' '; }
+        len += (size_t)wz_format_double(v.data[i], buf + len);
+    }
+    fwrite(buf, 1, len, stdout);
+    fputs("]\n", stdout);
+}
+
+WZ_DEF void print_reduction_runtime(const char* label, const char* name, double value) {
+    char text[WZ_DOUBLE_CHARS];
+    wz_format_double(value, text);
+    printf("%s of %s: %s\n", label, name, text);
+}
+
+// --- Data loading ---
+// Single-pass text loader over an mmap'd file or a buffered pipe/stdin stream,
+// filling one or several columns per scan (split across threads for large
+// inputs), with an optional binary columnar cache next to each input.
+
+// Mapped or buffered view of an input file
+typedef struct {
+    const char* data;
+    size_t size;
+    void* map;  // non-NULL when data is an mmap of a regular file
+    char* buf;  // non-NULL when data was read into a heap buffer
+} InputView;
+
+// Opens a data file for a single forward scan. Regular files are mmap'd;
+// pipes and stdin ("-") cannot be rewound, so they are read into a growable buffer.
+static int open_input_view(const char* filename, InputView* in) {
+    memset(in, 0, sizeof(*in));
+    int fd = (strcmp(filename, "-") == 0) ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "Error opening file: %s\n", filename); return 0; }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) { if (fd != STDIN_FILENO) close(fd); return 1; }
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+            in->map = p; in->data = (const char*)p; in->size = (size_t)st.st_size;
+            profile_read(in->size);
+            if (fd != STDIN_FILENO) close(fd);
+            return 1;
+        }
+    }
+    size_t cap = 1 << 16, len = 0;
+    char* buf = (char*)malloc(cap);
+    if (!buf) { fprintf(stderr, "Input buffer allocation failed\n"); exit(1); }
+    for (;;) {
+        if (len == cap) {
+            cap *= 2;
+            buf = (char*)realloc(buf, cap);
+            if (!buf) { fprintf(stderr, "Input buffer allocation failed\n"); exit(1); }
+        }
+        ssize_t r = read(fd, buf + len, cap - len);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error reading file: %s\n", filename);
+            free(buf); if (fd != STDIN_FILENO) close(fd);
+            return 0;
+        }
+        if (r == 0) break;
+        len += (size_t)r;
+    }
+    if (fd != STDIN_FILENO) close(fd);
+    in->buf = buf; in->data = buf; in->size = len;
+    profile_read(len);
+    return 1;
+}
+
+static void close_input_view(InputView* in) {
+    if (in->map) munmap(in->map, in->size);
+    free(in->buf);
+    memset(in, 0, sizeof(*in));
+}
+
+static int is_field_delim(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+// Parses one numeric field [p, end) with atof semantics. Plain decimals that
+// fit the exact fast path avoid strtod; anything else goes through strtod on a
+// NUL-terminated copy, since a mapped file is not NUL-terminated.
+static double parse_field(const char* p, const char* end) {
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* s = p;
+    int neg = 0;
+    if (s < end && (*s == '-' || *s == '+')) { neg = (*s == '-'); s++; }
+    unsigned long long mant = 0; int digits = 0, scale = 0, any = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+        if (digits < 19) { mant = mant * 10 + (unsigned)(*s - '0'); if (mant) digits++; } else scale++;
+        s++; any = 1;
+    }
+    if (s < end && *s == '.') {
+        s++;
+        while (s < end && *s >= '0' && *s <= '9') {
+            if (digits < 19) { mant = mant * 10 + (unsigned)(*s - '0'); if (mant) digits++; scale--; }
+            s++; any = 1;
+        }
+    }
+    if (any && s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1; int eneg = 0, ex = 0, edig = 0;
+        if (e < end && (*e == '-' || *e == '+')) { eneg = (*e == '-'); e++; }
+        while (e < end && *e >= '0' && *e <= '9') { if (ex < 10000) ex = ex * 10 + (*e - '0'); e++; edig = 1; }
+        if (edig) { scale += eneg ? -ex : ex; s = e; }
+    }
+    if (any && s == end && mant < (1ULL << 53) && scale >= -22 && scale <= 22) {
+        double v = (double)mant;
+        v = (scale < 0) ? v / pow10[-scale] : v * pow10[scale];
+        return neg ? -v : v;
+    }
+    char tmp[64];
+    size_t n = (size_t)(end - p);
+    char* copy = (n < sizeof(tmp)) ? tmp : (char*)malloc(n + 1);
+    if (!copy) { fprintf(stderr, "Field buffer allocation failed\n"); exit(1); }
+    memcpy(copy, p, n); copy[n] = '\0';
+    double v = strtod(copy, NULL);
+    if (copy != tmp) free(copy);
+    return v;
+}
+
+// Parses the fields of the line [p, eol) into fields[0..maxcol] for which wanted[] is set;
+// missing fields read as 0.0
+static void parse_row_fields(const char* p, const char* eol, int maxcol, const char* wanted, double* fields) {
+    int col = 0;
+    const char* q = p;
+    while (q < eol && col <= maxcol) {
+        while (q < eol && is_field_delim(*q)) q++;
+        if (q >= eol) break;
+        const char* tok = q;
+        while (q < eol && !is_field_delim(*q)) q++;
+        if (wanted[col]) fields[col] = parse_field(tok, q);
+        col++;
+    }
+    for (; col <= maxcol; ++col) fields[col] = 0.0;
+}
+
+// --- Chunked (multi-threaded) parsing ---
+// Large inputs are split into newline-aligned chunks parsed in parallel, each
+// into its own row count and column values in a single pass; a prefix sum over
+// the chunk row counts then places every chunk at its final row offset.
+
+#ifndef WZ_LOAD_THREADS
+#define WZ_LOAD_THREADS 0 // Loader threads; 0 = one per online CPU (override with -DWZ_LOAD_THREADS=n)
+#endif
+#define WZ_PARALLEL_LOAD_MIN_BYTES (8u << 20) // Smaller inputs are parsed on the calling thread
+#define WZ_LOAD_MAX_THREADS 256
+
+// Thread count for an input of `bytes`: WIZUALL_LOAD_THREADS overrides WZ_LOAD_THREADS
+static int load_thread_count(size_t bytes) {
+    if (bytes < WZ_PARALLEL_LOAD_MIN_BYTES) return 1;
+    long n = WZ_LOAD_THREADS;
+    const char* env = getenv("WIZUALL_LOAD_THREADS");
+    if (env && *env) n = strtol(env, NULL, 10);
+    if (n <= 0) n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > WZ_LOAD_MAX_THREADS) n = WZ_LOAD_MAX_THREADS;
+    long by_size = (long)(bytes / (1u << 20)); // At least 1 MiB per thread
+    if (n > by_size) n = by_size;
+    return n < 1 ? 1 : (int)n;
+}
+
+// One chunk of input and the values parsed from it
+typedef struct {
+    const char* begin;
+    const char* end;
+    int ncols;           // Requested columns, or -1 to parse every column
+    const int* columns;
+    double** data;       // Per requested (or discovered) column, `rows` values each
+    int datacols;        // Number of arrays in data
+    size_t rows, cap;
+    size_t first_row;    // Final row offset of this chunk (prefix sum)
+    double** dest;       // Final column arrays, filled in the copy phase
+} ParseChunk;
+
+static void* parse_chunk(void* arg) {
+    ParseChunk* c = (ParseChunk*)arg;
+    int all = c->ncols < 0;
+    int maxcol = -1, colcap = all ? 8 : c->ncols;
+    for (int k = 0; !all && k < c->ncols; ++k) if (c->columns[k] > maxcol) maxcol = c->columns[k];
+    double* fields = all ? NULL : (double*)malloc((size_t)(maxcol + 1) * sizeof(double));
+    char* wanted = all ? NULL : (char*)calloc((size_t)maxcol + 1, 1);
+    c->data = (double**)malloc((size_t)(colcap > 0 ? colcap : 1) * sizeof(double*));
+    if ((!all && (!fields || !wanted)) || !c->data) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+    for (int k = 0; !all && k < c->ncols; ++k) if (c->columns[k] >= 0) wanted[c->columns[k]] = 1;
+    c->cap = (size_t)(c->end - c->begin) / (16 * (size_t)(maxcol + 2)) + 16;
+    c->rows = 0;
+    c->datacols = all ? 0 : c->ncols;
+    for (int k = 0; k < c->datacols; ++k) {
+        c->data[k] = (double*)malloc(c->cap * sizeof(double));
+        if (!c->data[k]) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+    }
+    const char* p = c->begin;
+    while (p < c->end) {
+        const char* eol = (const char*)memchr(p, '\n', (size_t)(c->end - p));
+        if (!eol) eol = c->end;
+        if (c->rows == c->cap) {
+            c->cap *= 2;
+            for (int k = 0; k < c->datacols; ++k) {
+                c->data[k] = (double*)realloc(c->data[k], c->cap * sizeof(double));
+                if (!c->data[k]) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+            }
+        }
+        if (all) {
+            int col = 0;
+            const char* q = p;
+            while (q < eol) {
+                while (q < eol && is_field_delim(*q)) q++;
+                if (q >= eol) break;
+                const char* tok = q;
+                while (q < eol && !is_field_delim(*q)) q++;
+                if (col == c->datacols) { // First row this wide: add a zero-filled column
+                    if (c->datacols == colcap) {
+                        colcap *= 2;
+                        c->data = (double**)realloc(c->data, (size_t)colcap * sizeof(double*));
+                        if (!c->data) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+                    }
+                    c->data[c->datacols] = (double*)calloc(c->cap, sizeof(double));
+                    if (!c->data[c->datacols]) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+                    c->datacols++;
+                }
+                c->data[col][c->rows] = parse_field(tok, q);
+                col++;
+            }
+            for (; col < c->datacols; ++col) c->data[col][c->rows] = 0.0;
+        } else {
+            parse_row_fields(p, eol, maxcol, wanted, fields);
+            for (int k = 0; k < c->ncols; ++k) c->data[k][c->rows] = (c->columns[k] >= 0) ? fields[c->columns[k]] : 0.0;
+        }
+        c->rows++;
+        p = eol + 1;
+    }
+    free(fields); free(wanted);
+    return NULL;
+}
+
+// Copy phase: moves a chunk's values to its final offset (zero-filling missing columns)
+static void* place_chunk(void* arg) {
+    ParseChunk* c = (ParseChunk*)arg;
+    for (int k = 0; c->dest[k]; ++k) {
+        if (k < c->datacols) memcpy(c->dest[k] + c->first_row, c->data[k], c->rows * sizeof(double));
+        else memset(c->dest[k] + c->first_row, 0, c->rows * sizeof(double));
+    }
+    for (int k = 0; k < c->datacols; ++k) free(c->data[k]);
+    free(c->data);
+    return NULL;
+}
+
+// Runs fn over every chunk: chunk 0 on the calling thread, the others on worker threads
+static void run_chunks(ParseChunk* chunks, int n, void* (*fn)(void*)) {
+    pthread_t tids[WZ_LOAD_MAX_THREADS];
+    int started[WZ_LOAD_MAX_THREADS];
+    for (int t = 1; t < n; ++t) started[t] = pthread_create(&tids[t], NULL, fn, &chunks[t]) == 0;
+    fn(&chunks[0]);
+    for (int t = 1; t < n; ++t) {
+        if (started[t]) pthread_join(tids[t], NULL);
+        else fn(&chunks[t]); // Could not start a thread: do the work here
+    }
+}
+
+// Parses the requested columns (ncols >= 0) or every column (ncols < 0) of an input.
+// Returns the column arrays (exactly *out_rows values each, NULL-terminated list of
+// *out_ncols arrays); rows lacking a column read as 0.0.
+static double** parse_columns(const InputView* in, int ncols, const int* columns, size_t* out_rows, int* out_ncols) {
+    int nthreads = load_thread_count(in->size);
+    ParseChunk chunks[WZ_LOAD_MAX_THREADS];
+    const char* end = in->data + in->size;
+    const char* p = in->data;
+    int n = 0;
+    for (int t = 0; t < nthreads && p < end; ++t) { // Newline-aligned split
+        const char* q = (t == nthreads - 1) ? end : in->data + in->size / (size_t)nthreads * (size_t)(t + 1);
+        if (q < p) q = p;
+        if (q < end) {
+            q = (const char*)memchr(q, '\n', (size_t)(end - q));
+            q = q ? q + 1 : end;
+        }
+        memset(&chunks[n], 0, sizeof(ParseChunk));
+        chunks[n].begin = p; chunks[n].end = q;
+        chunks[n].ncols = ncols; chunks[n].columns = columns;
+        n++;
+        p = q;
+    }
+    if (n == 0) { // Empty input
+        memset(&chunks[0], 0, sizeof(ParseChunk));
+        chunks[0].begin = chunks[0].end = in->data; chunks[0].ncols = ncols; chunks[0].columns = columns;
+        n = 1;
+    }
+    run_chunks(chunks, n, parse_chunk);
+
+    size_t rows = 0;
+    int width = 0;
+    for (int t = 0; t < n; ++t) { // Prefix sum of chunk row counts
+        chunks[t].first_row = rows;
+        rows += chunks[t].rows;
+        if (chunks[t].datacols > width) width = chunks[t].datacols;
+    }
+    double** cols = (double**)calloc((size_t)width + 1, sizeof(double*));
+    if (!cols) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+    if (n == 1 && chunks[0].datacols == width) { // Single chunk: hand its arrays over
+        for (int k = 0; k < width; ++k) {
+            cols[k] = chunks[0].data[k];
+            if (rows > 0 && rows < chunks[0].cap) {
+                double* shrunk = (double*)realloc(cols[k], rows * sizeof(double));
+                if (shrunk) cols[k] = shrunk;
+            }
+        }
+        free(chunks[0].data);
+    } else {
+        for (int k = 0; k < width; ++k) {
+            cols[k] = (double*)malloc((rows ? rows : 1) * sizeof(double));
+            if (!cols[k]) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+        }
+        for (int t = 0; t < n; ++t) chunks[t].dest = cols;
+        run_chunks(chunks, n, place_chunk);
+    }
+    *out_rows = rows; *out_ncols = width;
+    return cols;
+}
+
+// --- Binary columnar cache ---
+// A sidecar file "<input>.wzcache" holds every column of a parsed text file as
+// raw doubles, keyed by the input's real path, device/inode, size and mtime.
+// Cache hits map the sidecar read-only and hand out non-owning Vector views.
+// Those views may outlive any later load, so mappings stay until exit.
+
+#define WZ_CACHE_MAGIC "WZCACHE1"
+
+typedef struct {
+    char magic[8];
+    unsigned long long src_dev, src_ino, src_size;
+    long long src_mtime_sec, src_mtime_nsec;
+    unsigned long long rows, ncols;
+    unsigned long long path_len;   // Length of the real path stored after the header
+    unsigned long long data_offset; // Offset of column 0 (64-byte aligned)
+} CacheHeader;
+
+typedef struct {
+    char* sidecar;
+    void* map;
+    size_t map_len;
+    const CacheHeader* hdr;
+    int stale;     // Input changed since; kept mapped for views still using it
+} CacheMapping;
+
+static CacheMapping* wz_cache_maps = NULL;
+static int wz_cache_map_count = 0, wz_cache_map_cap = 0;
+
+static int cache_header_matches(const CacheHeader* h, const struct stat* st, const char* realname) {
+    return memcmp(h->magic, WZ_CACHE_MAGIC, 8) == 0 &&
+           h->src_dev == (unsigned long long)st->st_dev && h->src_ino == (unsigned long long)st->st_ino &&
+           h->src_size == (unsigned long long)st->st_size &&
+           h->src_mtime_sec == (long long)st->st_mtim.tv_sec && h->src_mtime_nsec == (long long)st->st_mtim.tv_nsec &&
+           h->path_len == strlen(realname) && memcmp((const char*)(h + 1), realname, h->path_len) == 0;
+}
+
+// Returns a valid mapping of the sidecar for this input, or NULL on a miss
+static const CacheHeader* cache_map_sidecar(const char* sidecar, const struct stat* st, const char* realname) {
+    for (int i = 0; i < wz_cache_map_count; ++i) {
+        if (!wz_cache_maps[i].stale && strcmp(wz_cache_maps[i].sidecar, sidecar) == 0) {
+            if (cache_header_matches(wz_cache_maps[i].hdr, st, realname)) return wz_cache_maps[i].hdr;
+            wz_cache_maps[i].stale = 1; // Input changed: earlier loads may still point into it
+            break;
+        }
+    }
+    int fd = open(sidecar, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat cst;
+    if (fstat(fd, &cst) != 0 || (size_t)cst.st_size < sizeof(CacheHeader)) { close(fd); return NULL; }
+    size_t size = (size_t)cst.st_size;
+    void* p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    const CacheHeader* h = (const CacheHeader*)p;
+    // Bounds first, without overflow: the path must fit before the data, the columns after it
+    int valid = h->path_len <= size - sizeof(CacheHeader) &&
+                h->data_offset >= sizeof(CacheHeader) + h->path_len && h->data_offset <= size &&
+                h->data_offset % sizeof(double) == 0 &&
+                (h->ncols == 0 || h->rows <= (size - h->data_offset) / sizeof(double) / h->ncols) &&
+                cache_header_matches(h, st, realname);
+    if (valid && wz_cache_map_count == wz_cache_map_cap) {
+        int cap = wz_cache_map_cap ? wz_cache_map_cap * 2 : 16;
+        CacheMapping* grown = (CacheMapping*)realloc(wz_cache_maps, (size_t)cap * sizeof(CacheMapping));
+        if (grown) { wz_cache_maps = grown; wz_cache_map_cap = cap; }
+        else valid = 0;
+    }
+    char* name = valid ? strdup(sidecar) : NULL;
+    if (!name) { // Invalid, or nowhere to record it: a miss, so nothing points into it
+        munmap(p, size);
+        return NULL;
+    }
+    CacheMapping* m = &wz_cache_maps[wz_cache_map_count++];
+    m->sidecar = name; m->map = p; m->map_len = size; m->hdr = h; m->stale = 0;
+    return h;
+}
+
+// Writes the sidecar atomically (temp file + rename); failures are silently ignored
+static void cache_write_sidecar(const char* sidecar, const struct stat* st, const char* realname,
+                                double** cols, size_t rows, int ncols) {
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, WZ_CACHE_MAGIC, 8);
+    h.src_dev = (unsigned long long)st->st_dev; h.src_ino = (unsigned long long)st->st_ino;
+    h.src_size = (unsigned long long)st->st_size;
+    h.src_mtime_sec = (long long)st->st_mtim.tv_sec; h.src_mtime_nsec = (long long)st->st_mtim.tv_nsec;
+    h.rows = rows; h.ncols = (unsigned long long)ncols;
+    h.path_len = strlen(realname);
+    h.data_offset = (sizeof(h) + h.path_len + 63) & ~63ULL;
+    size_t tmplen = strlen(sidecar) + 32;
+    char* tmp = (char*)malloc(tmplen);
+    if (!tmp) return;
+    snprintf(tmp, tmplen, "%s.%ld.tmp", sidecar, (long)getpid());
+    FILE* f = fopen(tmp, "wb");
+    if (!f) { free(tmp); return; }
+    static const char zeros[64] = {0};
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(realname, 1, h.path_len, f) == h.path_len &&
+             fwrite(zeros, 1, h.data_offset - sizeof(h) - h.path_len, f) == h.data_offset - sizeof(h) - h.path_len;
+    for (int k = 0; k < ncols && ok; ++k) ok = fwrite(cols[k], sizeof(double), rows, f) == rows;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok || rename(tmp, sidecar) != 0) remove(tmp);
+    free(tmp);
+}
+
+// Serves columns from the cache, building the sidecar on a miss.
+// Returns 0 if the cache cannot be used for this input (caller parses as usual).
+static int cache_load_columns(const char* filename, int ncols, const int* columns, Vector** outs) {
+    struct stat st;
+    if (strcmp(filename, "-") == 0 || stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    char* realname = realpath(filename, NULL);
+    if (!realname) return 0;
+    size_t sidelen = strlen(filename) + sizeof(".wzcache");
+    char* sidecar = (char*)malloc(sidelen);
+    if (!sidecar) { free(realname); return 0; }
+    snprintf(sidecar, sidelen, "%s.wzcache", filename);
+
+    const CacheHeader* h = cache_map_sidecar(sidecar, &st, realname);
+    if (h) { // Hit: views into the mapping, no parsing
+        const double* base = (const double*)((const char*)h + h->data_offset);
+        for (int k = 0; k < ncols; ++k) {
+            if (columns[k] >= 0 && (unsigned long long)columns[k] < h->ncols) {
+                outs[k]->data = (double*)(base + (size_t)columns[k] * h->rows);
+                outs[k]->size = h->rows; outs[k]->owned = 0;
+                profile_read(h->rows * sizeof(double));
+            } else {
+                *outs[k] = create_vector(h->rows);
+            }
+        }
+    } else { // Miss: parse every column once, persist, hand out the requested ones
+        InputView in;
+        if (!open_input_view(filename, &in)) { free(sidecar); free(realname); return 0; }
+        size_t rows; int allcols;
+        double** cols = parse_columns(&in, -1, NULL, &rows, &allcols);
+        close_input_view(&in);
+        profile_alloc((size_t)allcols * rows * sizeof(double)); // Every column, for the sidecar
+        cache_write_sidecar(sidecar, &st, realname, cols, rows, allcols);
+        char* handed = (char*)calloc((size_t)allcols + 1, 1);
+        if (!handed) { fprintf(stderr, "Vector allocation failed\n"); exit(1); }
+        for (int k = 0; k < ncols; ++k) {
+            int c = columns[k];
+            if (c >= 0 && c < allcols && !handed[c]) {
+                outs[k]->data = cols[c]; outs[k]->size = rows; outs[k]->owned = 1;
+                handed[c] = 1;
+            } else {
+                *outs[k] = alloc_vector(rows);
+                if (c >= 0 && c < allcols) memcpy(outs[k]->data, cols[c], rows * sizeof(double));
+                else memset(outs[k]->data, 0, rows * sizeof(double));
+            }
+        }
+        for (int c = 0; c < allcols; ++c) if (!handed[c]) free(cols[c]);
+        free(handed); free(cols);
+    }
+    free(sidecar); free(realname);
+    return 1;
+}
+
+// Loads several columns of a whitespace/comma separated text file in one
+// pass. Every line is one row (a row without a column reads as 0.0); lines
+// may be of any length. Only the requested fields are converted.
+WZ_DEF void load_vector_columns(const char* filename, int ncols, const int* columns, Vector** outs) {
+    for (int k = 0; k < ncols; ++k) { outs[k]->data = NULL; outs[k]->size = 0; outs[k]->owned = 0; }
+    if (wz_cache_enabled && cache_load_columns(filename, ncols, columns, outs)) return;
+    InputView in;
+    if (!open_input_view(filename, &in)) return;
+    size_t rows; int width;
+    double** cols = parse_columns(&in, ncols, columns, &rows, &width);
+    close_input_view(&in);
+    for (int k = 0; k < ncols; ++k) {
+        outs[k]->data = cols[k]; outs[k]->size = rows; outs[k]->owned = 1;
+    }
+    profile_alloc((size_t)ncols * rows * sizeof(double));
+    free(cols);
+}
+
+// Loads one column; see load_vector_columns
+WZ_DEF Vector load_vector_column(const char* filename, int column) {
+    Vector v;
+    Vector* out = &v;
+    load_vector_columns(filename, 1, &column, &out);
+    return v;
+}
+
+// --- Reduction kernels ---
+// sum/min/max/sum-of-squared-deviations over a double array, each using four
+// independent SIMD accumulators. Variants are stamped out per instruction set
+// (AVX2 and SSE2 on x86, via GCC vector extensions) plus a portable scalar
+// fallback; the best supported variant is picked at run time.
+
+typedef struct {
+    const char* isa;
+    double (*sum)(const double* x, size_t n);
+    double (*sum_kahan)(const double* x, size_t n);
+    double (*min)(const double* x, size_t n);
+    double (*max)(const double* x, size_t n);
+    double (*sumsq_dev)(const double* x, size_t n, double mean);
+    double (*sumsq_dev_kahan)(const double* x, size_t n, double mean);
+} ReduceKernels;
+
+// Portable fallback (four scalar accumulators)
+static double wz_sum_scalar(const double* x, size_t n) {
+    double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0; size_t i = 0;
+    for (; i + 4 <= n; i += 4) { a0 += x[i]; a1 += x[i + 1]; a2 += x[i + 2]; a3 += x[i + 3]; }
+    for (; i < n; ++i) a0 += x[i];
+    return (a0 + a1) + (a2 + a3);
+}
+static double wz_sum_kahan_scalar(const double* x, size_t n) {
+    double s = 0.0, c = 0.0;
+    for (size_t i = 0; i < n; ++i) { double y = x[i] - c; double t = s + y; c = (t - s) - y; s = t; }
+    return s;
+}
+static double wz_min_scalar(const double* x, size_t n) {
+    double m = INFINITY;
+    for (size_t i = 0; i < n; ++i) m = (x[i] < m) ? x[i] : m;
+    return m;
+}
+static double wz_max_scalar(const double* x, size_t n) {
+    double m = -INFINITY;
+    for (size_t i = 0; i < n; ++i) m = (x[i] > m) ? x[i] : m;
+    return m;
+}
+static double wz_sumsq_dev_scalar(const double* x, size_t n, double mean) {
+    double a0 = 0.0, a1 = 0.0; size_t i = 0;
+    for (; i + 2 <= n; i += 2) { double d0 = x[i] - mean, d1 = x[i + 1] - mean; a0 += d0 * d0; a1 += d1 * d1; }
+    for (; i < n; ++i) { double d = x[i] - mean; a0 += d * d; }
+    return a0 + a1;
+}
+static double wz_sumsq_dev_kahan_scalar(const double* x, size_t n, double mean) {
+    double s = 0.0, c = 0.0;
+    for (size_t i = 0; i < n; ++i) { double d = x[i] - mean; double y = d * d - c; double t = s + y; c = (t - s) - y; s = t; }
+    return s;
+}
+static const ReduceKernels wz_kernels_scalar = { "scalar", wz_sum_scalar, wz_sum_kahan_scalar, wz_min_scalar,
+                                                 wz_max_scalar, wz_sumsq_dev_scalar, wz_sumsq_dev_kahan_scalar };
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WZ_HAVE_SIMD_KERNELS 1
+// Stamps out the kernel set for one instruction set: ISA names the variant,
+// LANES is the number of doubles per vector register, ATTR the target attribute.
+#define WZ_DEFINE_SIMD_KERNELS(ISA, LANES, ATTR) \
+typedef double wz_vd_##ISA __attribute__((vector_size(LANES * 8))); \
+typedef long long wz_vm_##ISA __attribute__((vector_size(LANES * 8))); \
+ATTR static double wz_hsum_##ISA(wz_vd_##ISA v) { \
+    double s = 0.0; for (int l = 0; l < LANES; ++l) s += v[l]; return s; \
+} \
+ATTR static double wz_sum_##ISA(const double* x, size_t n) { \
+    wz_vd_##ISA a0 = {0}, a1 = {0}, a2 = {0}, a3 = {0}, v0, v1, v2, v3; size_t i = 0; \
+    for (; i + 4 * LANES <= n; i += 4 * LANES) { \
+        memcpy(&v0, x + i, sizeof v0); memcpy(&v1, x + i + LANES, sizeof v1); \
+        memcpy(&v2, x + i + 2 * LANES, sizeof v2); memcpy(&v3, x + i + 3 * LANES, sizeof v3); \
+        a0 += v0; a1 += v1; a2 += v2; a3 += v3; \
+    } \
+    double s = wz_hsum_##ISA((a0 + a1) + (a2 + a3)); \
+    for (; i < n; ++i) s += x[i]; \
+    return s; \
+} \
+ATTR static double wz_sum_kahan_##ISA(const double* x, size_t n) { \
+    wz_vd_##ISA s0 = {0}, c0 = {0}, s1 = {0}, c1 = {0}, v, y, t; size_t i = 0; \
+    for (; i + 2 * LANES <= n; i += 2 * LANES) { \
+        memcpy(&v, x + i, sizeof v); y = v - c0; t = s0 + y; c0 = (t - s0) - y; s0 = t; \
+        memcpy(&v, x + i + LANES, sizeof v); y = v - c1; t = s1 + y; c1 = (t - s1) - y; s1 = t; \
+    } \
+    double s = 0.0, c = 0.0, parts[2 * LANES + 2]; int np = 0; \
+    for (int l = 0; l < LANES; ++l) { parts[np++] = s0[l]; parts[np++] = s1[l]; } \
+    parts[np++] = -wz_hsum_##ISA(c0); parts[np++] = -wz_hsum_##ISA(c1); \
+    for (; i < n; ++i) { double yy = x[i] - c; double tt = s + yy; c = (tt - s) - yy; s = tt; } \
+    for (int k = 0; k < np; ++k) { double yy = parts[k] - c; double tt = s + yy; c = (tt - s) - yy; s = tt; } \
+    return s; \
+} \
+ATTR static double wz_min_##ISA(const double* x, size_t n) { \
+    wz_vd_##ISA m0, m1, m2, m3, v; wz_vm_##ISA k; size_t i = 0; \
+    for (int l = 0; l < LANES; ++l) { m0[l] = INFINITY; } m1 = m0; m2 = m0; m3 = m0; \
+    for (; i + 4 * LANES <= n; i += 4 * LANES) { \
+        memcpy(&v, x + i, sizeof v); k = v < m0; m0 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m0 & ~k)); \
+        memcpy(&v, x + i + LANES, sizeof v); k = v < m1; m1 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m1 & ~k)); \
+        memcpy(&v, x + i + 2 * LANES, sizeof v); k = v < m2; m2 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m2 & ~k)); \
+        memcpy(&v, x + i + 3 * LANES, sizeof v); k = v < m3; m3 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m3 & ~k)); \
+    } \
+    double m = INFINITY; \
+    for (int l = 0; l < LANES; ++l) { \
+        m = (m0[l] < m) ? m0[l] : m; m = (m1[l] < m) ? m1[l] : m; m = (m2[l] < m) ? m2[l] : m; m = (m3[l] < m) ? m3[l] : m; \
+    } \
+    for (; i < n; ++i) m = (x[i] < m) ? x[i] : m; \
+    return m; \
+} \
+ATTR static double wz_max_##ISA(const double* x, size_t n) { \
+    wz_vd_##ISA m0, m1, m2, m3, v; wz_vm_##ISA k; size_t i = 0; \
+    for (int l = 0; l < LANES; ++l) { m0[l] = -INFINITY; } m1 = m0; m2 = m0; m3 = m0; \
+    for (; i + 4 * LANES <= n; i += 4 * LANES) { \
+        memcpy(&v, x + i, sizeof v); k = v > m0; m0 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m0 & ~k)); \
+        memcpy(&v, x + i + LANES, sizeof v); k = v > m1; m1 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m1 & ~k)); \
+        memcpy(&v, x + i + 2 * LANES, sizeof v); k = v > m2; m2 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m2 & ~k)); \
+        memcpy(&v, x + i + 3 * LANES, sizeof v); k = v > m3; m3 = (wz_vd_##ISA)(((wz_vm_##ISA)v & k) | ((wz_vm_##ISA)m3 & ~k)); \
+    } \
+    double m = -INFINITY; \
+    for (int l = 0; l < LANES; ++l) { \
+        m = (m0[l] > m) ? m0[l] : m; m = (m1[l] > m) ? m1[l] : m; m = (m2[l] > m) ? m2[l] : m; m = (m3[l] > m) ? m3[l] : m; \
+    } \
+    for (; i < n; ++i) m = (x[i] > m) ? x[i] : m; \
+    return m; \
+} \
+ATTR static double wz_sumsq_dev_##ISA(const double* x, size_t n, double mean) { \
+    wz_vd_##ISA a0 = {0}, a1 = {0}, mu, v0, v1; size_t i = 0; \
+    for (int l = 0; l < LANES; ++l) mu[l] = mean; \
+    for (; i + 2 * LANES <= n; i += 2 * LANES) { \
+        memcpy(&v0, x + i, sizeof v0); memcpy(&v1, x + i + LANES, sizeof v1); \
+        v0 -= mu; v1 -= mu; a0 += v0 * v0; a1 += v1 * v1; \
+    } \
+    double s = wz_hsum_##ISA(a0 + a1); \
+    for (; i < n; ++i) { double d = x[i] - mean; s += d * d; } \
+    return s; \
+} \
+ATTR static double wz_sumsq_dev_kahan_##ISA(const double* x, size_t n, double mean) { \
+    wz_vd_##ISA s0 = {0}, c0 = {0}, mu, v, y, t; size_t i = 0; \
+    for (int l = 0; l < LANES; ++l) mu[l] = mean; \
+    for (; i + LANES <= n; i += LANES) { \
+        memcpy(&v, x + i, sizeof v); v -= mu; y = v * v - c0; t = s0 + y; c0 = (t - s0) - y; s0 = t; \
+    } \
+    double s = 0.0, c = 0.0; \
+    for (int l = 0; l < LANES; ++l) { double yy = s0[l] - c; double tt = s + yy; c = (tt - s) - yy; s = tt; } \
+    { double yy = -wz_hsum_##ISA(c0) - c; double tt = s + yy; c = (tt - s) - yy; s = tt; } \
+    for (; i < n; ++i) { double d = x[i] - mean; double yy = d * d - c; double tt = s + yy; c = (tt - s) - yy; s = tt; } \
+    return s; \
+} \
+static const ReduceKernels wz_kernels_##ISA = { #ISA, wz_sum_##ISA, wz_sum_kahan_##ISA, wz_min_##ISA, \
+                                                wz_max_##ISA, wz_sumsq_dev_##ISA, wz_sumsq_dev_kahan_##ISA };
+
+WZ_DEFINE_SIMD_KERNELS(avx2, 4, __attribute__((target("avx2"))))
+WZ_DEFINE_SIMD_KERNELS(sse2, 2, __attribute__((target("sse2"))))
+#endif
+
+// Picks the kernel set once: WIZUALL_SIMD=avx2|sse2|scalar overrides CPU detection
+static const ReduceKernels* reduce_kernels(void) {
+    static const ReduceKernels* selected = NULL;
+    if (selected) return selected;
+    const ReduceKernels* k = &wz_kernels_scalar;
+#ifdef WZ_HAVE_SIMD_KERNELS
+    const char* env = getenv("WIZUALL_SIMD");
+    __builtin_cpu_init();
+    if (env && strcmp(env, "scalar") == 0) k = &wz_kernels_scalar;
+    else if (env && strcmp(env, "sse2") == 0) k = &wz_kernels_sse2;
+    else if (__builtin_cpu_supports("avx2")) k = &wz_kernels_avx2;
+    else k = &wz_kernels_sse2;
+#endif
+    selected = k;
+    return k;
+}
+
+// --- Parallel execution (wizuallc --parallel) ---
+// Element-wise loops and reductions over at least parallel_min_elements() elements
+// are split across OpenMP threads; smaller vectors stay single-threaded so they
+// do not pay the thread start-up cost. Without -fopenmp everything runs serially.
+
+#ifndef WZ_PARALLEL_MIN_ELEMENTS
+#define WZ_PARALLEL_MIN_ELEMENTS 65536 // Override with -DWZ_PARALLEL_MIN_ELEMENTS=n
+#endif
+#define WZ_MAX_PARALLEL_THREADS 256
+
+// Parallel threshold in elements: WIZUALL_PARALLEL_MIN overrides WZ_PARALLEL_MIN_ELEMENTS
+WZ_DEF size_t parallel_min_elements(void) {
+    static size_t min_elements = 0;
+    if (min_elements == 0) {
+        const char* env = getenv("WIZUALL_PARALLEL_MIN");
+        long long v = (env && *env) ? strtoll(env, NULL, 10) : 0;
+        min_elements = (v > 0) ? (size_t)v : WZ_PARALLEL_MIN_ELEMENTS;
+    }
+    return min_elements;
+}
+
+// Threads to use for an operation over n elements
+static int parallel_threads(size_t n) {
+#ifdef _OPENMP
+    if (wz_parallel && n >= parallel_min_elements()) {
+        int t = omp_get_max_threads();
+        return t > WZ_MAX_PARALLEL_THREADS ? WZ_MAX_PARALLEL_THREADS : t;
+    }
+#else
+    (void)n;
+#endif
+    return 1;
+}
+
+// --- Reduction built-ins ---
+// Sums use the compensated (Kahan) kernels when wizuallc --compensated-sum is set.
+
+enum { WZ_RED_SUM, WZ_RED_MIN, WZ_RED_MAX, WZ_RED_SUMSQ_DEV };
+
+static double reduce_chunk(const ReduceKernels* k, int op, const double* x, size_t n, double mean) {
+    switch (op) {
+        case WZ_RED_SUM: return wz_compensated_sum ? k->sum_kahan(x, n) : k->sum(x, n);
+        case WZ_RED_MIN: return k->min(x, n);
+        case WZ_RED_MAX: return k->max(x, n);
+        default: return wz_compensated_sum ? k->sumsq_dev_kahan(x, n, mean) : k->sumsq_dev(x, n, mean);
+    }
+}
+
+// Reduces x[0..n) with op, splitting it into one contiguous chunk per thread and
+// combining the partial results in chunk order
+static double reduce_array(int op, const double* x, size_t n, double mean) {
+    const ReduceKernels* k = reduce_kernels();
+    int nt = parallel_threads(n);
+    if (nt <= 1) return reduce_chunk(k, op, x, n, mean);
+    double partial[WZ_MAX_PARALLEL_THREADS];
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+    for (int t = 0; t < nt; ++t) {
+        size_t lo = n / (size_t)nt * (size_t)t, hi = (t == nt - 1) ? n : n / (size_t)nt * (size_t)(t + 1);
+        partial[t] = reduce_chunk(k, op, x + lo, hi - lo, mean);
+    }
+    double r = partial[0], c = 0.0;
+    for (int t = 1; t < nt; ++t) {
+        if (op == WZ_RED_MIN) r = (partial[t] < r) ? partial[t] : r;
+        else if (op == WZ_RED_MAX) r = (partial[t] > r) ? partial[t] : r;
+        else { double y = partial[t] - c; double s = r + y; c = (s - r) - y; r = s; }
+    }
+    return r;
+}
+
+static double reduce_sum(const double* x, size_t n) {
+    return reduce_array(WZ_RED_SUM, x, n, 0.0);
+}
+
+WZ_DEF double sum_runtime(Vector v) {
+    return reduce_sum(v.data, v.size);
+}
+
+WZ_DEF double average_runtime(Vector v) {
+    if (v.size == 0) return 0.0;
+    return reduce_sum(v.data, v.size) / (double)v.size;
+}
+
+WZ_DEF double min_val_runtime(Vector v) { // +INFINITY for an empty vector; NaNs are ignored
+    return reduce_array(WZ_RED_MIN, v.data, v.size, 0.0);
+}
+
+WZ_DEF double max_val_runtime(Vector v) { // -INFINITY for an empty vector; NaNs are ignored
+    return reduce_array(WZ_RED_MAX, v.data, v.size, 0.0);
+}
+
+WZ_DEF double variance_runtime(Vector v) { // Population variance (two-pass)
+    if (v.size == 0) return 0.0;
+    double mean = average_runtime(v);
+    return reduce_array(WZ_RED_SUMSQ_DEV, v.data, v.size, mean) / (double)v.size;
+}
+
+WZ_DEF double stddev_runtime(Vector v) {
+    return sqrt(variance_runtime(v));
+}
+
+// Index of the first element equal to m, or -1
+static double find_first_runtime(Vector v, double m) {
+    int nt = parallel_threads(v.size);
+    size_t found[WZ_MAX_PARALLEL_THREADS];
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+    for (int t = 0; t < nt; ++t) {
+        size_t lo = v.size / (size_t)nt * (size_t)t, hi = (t == nt - 1) ? v.size : v.size / (size_t)nt * (size_t)(t + 1);
+        found[t] = hi;
+        for (size_t i = lo; i < hi; ++i) {
+            if (v.data[i] == m) { found[t] = i; break; }
+        }
+    }
+    for (int t = 0; t < nt; ++t) {
+        size_t hi = (t == nt - 1) ? v.size : v.size / (size_t)nt * (size_t)(t + 1);
+        if (found[t] < hi) return (double)found[t];
+    }
+    return -1.0;
+}
+
+WZ_DEF double argmin_runtime(Vector v) { // 0-based index of the first minimum, -1 if empty
+    return find_first_runtime(v, min_val_runtime(v));
+}
+
+WZ_DEF double argmax_runtime(Vector v) { // 0-based index of the first maximum, -1 if empty
+    return find_first_runtime(v, max_val_runtime(v));
+}
+
+// --- Streaming reductions ---
+// A loaded vector whose only uses are reduction built-ins is never materialized:
+// the file is read through a fixed-size buffer and the parsed values are folded,
+// one block at a time, into running statistics. Memory use does not depend on
+// the input size, so files larger than RAM can be reduced.
+
+#define WZ_STREAM_READ_BYTES (1u << 20) // Read buffer (grows only for a longer line)
+
+WZ_DEF void stream_stats_reset(StreamStats* s) {
+    s->n = 0; s->nblock = 0;
+    s->sum = s->sum_c = s->mean = s->m2 = 0.0;
+    s->min = INFINITY; s->max = -INFINITY;
+    s->argmin = s->argmax = (size_t)-1;
+}
+
+// Folds n values (the rows following the s->n already seen) into the statistics.
+// Sums, means and squared deviations are merged per block (Chan et al.), which
+// keeps the single pass as accurate as the two-pass in-memory variance.
+static void stream_stats_fold(StreamStats* s, const double* x, size_t n) {
+    if (n == 0) return;
+    const ReduceKernels* k = reduce_kernels();
+    double bsum = reduce_chunk(k, WZ_RED_SUM, x, n, 0.0);
+    double bmean = bsum / (double)n;
+    double bm2 = reduce_chunk(k, WZ_RED_SUMSQ_DEV, x, n, bmean);
+    double bmin = k->min(x, n), bmax = k->max(x, n);
+
+    double y = bsum - s->sum_c, t = s->sum + y;
+    s->sum_c = (t - s->sum) - y; s->sum = t;
+    double total = (double)(s->n + n), delta = bmean - s->mean;
+    s->mean += delta * ((double)n / total);
+    s->m2 += bm2 + delta * delta * ((double)s->n * (double)n / total);
+
+    // Strict comparisons keep the first occurrence, as argmin/argmax do in memory
+    if (bmin < s->min || (s->argmin == (size_t)-1 && bmin == s->min)) {
+        for (size_t i = 0; i < n; ++i) if (x[i] == bmin) { s->min = bmin; s->argmin = s->n + i; break; }
+    }
+    if (bmax > s->max || (s->argmax == (size_t)-1 && bmax == s->max)) {
+        for (size_t i = 0; i < n; ++i) if (x[i] == bmax) { s->max = bmax; s->argmax = s->n + i; break; }
+    }
+    s->n += n;
+}
+
+static void stream_stats_push(StreamStats* s, double v) {
+    s->block[s->nblock++] = v;
+    if (s->nblock == WZ_STREAM_BLOCK) { stream_stats_fold(s, s->block, s->nblock); s->nblock = 0; }
+}
+
+// Serves columns from a valid binary cache (see load_vector_columns) without
+// building one on a miss, which would need every column in memory.
+// Returns 0 if there is no usable cache for this input.
+static int stream_cache_columns(const char* filename, int ncols, const int* columns, StreamStats** outs) {
+    struct stat st;
+    if (strcmp(filename, "-") == 0 || stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    char* realname = realpath(filename, NULL);
+    if (!realname) return 0;
+    size_t sidelen = strlen(filename) + sizeof(".wzcache");
+    char* sidecar = (char*)malloc(sidelen);
+    if (!sidecar) { free(realname); return 0; }
+    snprintf(sidecar, sidelen, "%s.wzcache", filename);
+    const CacheHeader* h = cache_map_sidecar(sidecar, &st, realname);
+    free(sidecar); free(realname);
+    if (!h) return 0;
+    const double* base = (const double*)((const char*)h + h->data_offset);
+    for (int k = 0; k < ncols; ++k) {
+        if (columns[k] >= 0 && (unsigned long long)columns[k] < h->ncols) {
+            const double* col = base + (size_t)columns[k] * h->rows;
+            profile_read(h->rows * sizeof(double));
+            for (size_t i = 0; i < h->rows; i += WZ_STREAM_BLOCK) {
+                size_t n = (h->rows - i < WZ_STREAM_BLOCK) ? h->rows - i : WZ_STREAM_BLOCK;
+                stream_stats_fold(outs[k], col + i, n);
+            }
+        } else {
+            for (size_t i = 0; i < h->rows; ++i) stream_stats_push(outs[k], 0.0);
+        }
+    }
+    return 1;
+}
+
+// Reduces several columns of a text file in one streaming pass; rows are split
+// into fields exactly as load_vector_columns does.
+WZ_DEF void stream_columns_stats(const char* filename, int ncols, const int* columns, StreamStats** outs) {
+    for (int k = 0; k < ncols; ++k) stream_stats_reset(outs[k]);
+    if (!(wz_cache_enabled && stream_cache_columns(filename, ncols, columns, outs))) {
+        int fd = (strcmp(filename, "-") == 0) ? STDIN_FILENO : open(filename, O_RDONLY);
+        if (fd < 0) { fprintf(stderr, "Error opening file: %s\n", filename); return; }
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        int maxcol = 0;
+        for (int k = 0; k < ncols; ++k) if (columns[k] > maxcol) maxcol = columns[k];
+        double* fields = (double*)malloc((size_t)(maxcol + 1) * sizeof(double));
+        char* wanted = (char*)calloc((size_t)maxcol + 1, 1);
+        size_t cap = WZ_STREAM_READ_BYTES, len = 0;
+        char* buf = (char*)malloc(cap);
+        if (!fields || !wanted || !buf) { fprintf(stderr, "Stream buffer allocation failed\n"); exit(1); }
+        for (int k = 0; k < ncols; ++k) if (columns[k] >= 0) wanted[columns[k]] = 1;
+        int eof = 0;
+        while (!eof) {
+            if (len == cap) { // A single line fills the buffer
+                cap *= 2;
+                buf = (char*)realloc(buf, cap);
+                if (!buf) { fprintf(stderr, "Stream buffer allocation failed\n"); exit(1); }
+            }
+            ssize_t r = read(fd, buf + len, cap - len);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                fprintf(stderr, "Error reading file: %s\n", filename);
+                break;
+            }
+            if (r == 0) eof = 1;
+            len += (size_t)r;
+            profile_read((size_t)r);
+            const char* p = buf;
+            const char* end = buf + len;
+            for (;;) {
+                const char* eol = (const char*)memchr(p, '\n', (size_t)(end - p));
+                if (!eol) {
+                    if (!eof || p == end) break;
+                    eol = end; // Last line without a trailing newline
+                }
+                parse_row_fields(p, eol, maxcol, wanted, fields);
+                for (int k = 0; k < ncols; ++k) stream_stats_push(outs[k], (columns[k] >= 0) ? fields[columns[k]] : 0.0);
+                p = (eol < end) ? eol + 1 : end;
+            }
+            len = (size_t)(end - p);
+            memmove(buf, p, len);
+        }
+        if (fd != STDIN_FILENO) close(fd);
+        free(buf); free(wanted); free(fields);
+    }
+    for (int k = 0; k < ncols; ++k) {
+        stream_stats_fold(outs[k], outs[k]->block, outs[k]->nblock);
+        outs[k]->nblock = 0;
+    }
+}
+
+// Reduces one column; see stream_columns_stats
+WZ_DEF void stream_column_stats(const char* filename, int column, StreamStats* out) {
+    stream_columns_stats(filename, 1, &column, &out);
+}
+
+// Streamed counterparts of the reduction built-ins
+WZ_DEF double sum_stream(const StreamStats* s) { return s->sum; }
+WZ_DEF double average_stream(const StreamStats* s) { return s->n ? s->sum / (double)s->n : 0.0; }
+WZ_DEF double min_val_stream(const StreamStats* s) { return s->min; }
+WZ_DEF double max_val_stream(const StreamStats* s) { return s->max; }
+WZ_DEF double variance_stream(const StreamStats* s) { return s->n ? s->m2 / (double)s->n : 0.0; }
+WZ_DEF double stddev_stream(const StreamStats* s) { return sqrt(variance_stream(s)); }
+WZ_DEF double argmin_stream(const StreamStats* s) { return s->argmin == (size_t)-1 ? -1.0 : (double)s->argmin; }
+WZ_DEF double argmax_stream(const StreamStats* s) { return s->argmax == (size_t)-1 ? -1.0 : (double)s->argmax; }
+
+// --- Plotting ---
+// Points are sent straight down the gnuplot pipe as raw float64 pairs
+// (gnuplot's binary '-' input), so no temp file or text formatting is involved.
+
+#define WZ_PLOT_CHUNK 4096 // Points interleaved and written per fwrite
+
+static FILE* open_gnuplot(void) {
+    FILE* gp = popen("gnuplot -persist", "w");
+    if (!gp) {
+        fprintf(stderr, "Error opening gnuplot pipe.\n");
+    }
+    return gp;
+}
+
+// --- Plot decimation ---
+// Series longer than the target resolution are downsampled before plotting,
+// since gnuplot cannot draw more points than the output has pixels anyway.
+// "minmax" keeps the lowest and highest point of every bucket (every spike
+// survives); "lttb" (Largest-Triangle-Three-Buckets) keeps the point of each
+// bucket forming the largest triangle with its neighbours and needs x sorted.
+
+enum { WZ_DECIMATE_MINMAX, WZ_DECIMATE_LTTB };
+
+// Target point count: WIZUALL_PLOT_POINTS overrides wizuallc --plot-points (0 = no decimation)
+static size_t plot_target_points(void) {
+    const char* env = getenv("WIZUALL_PLOT_POINTS");
+    if (env && *env) {
+        long long v = strtoll(env, NULL, 10);
+        return v > 0 ? (size_t)v : 0;
+    }
+    return wz_plot_points;
+}
+
+// Method: WIZUALL_PLOT_DECIMATE=minmax|lttb overrides wizuallc --plot-decimate
+static int plot_decimate_method(void) {
+    const char* env = getenv("WIZUALL_PLOT_DECIMATE");
+    if (env && strcmp(env, "lttb") == 0) return WZ_DECIMATE_LTTB;
+    if (env && strcmp(env, "minmax") == 0) return WZ_DECIMATE_MINMAX;
+    return wz_plot_decimate;
+}
+
+// Fills idx[] with ascending indices of at most target (>= 4) points of y[0..n)
+// and returns their count. The first and last points are always kept.
+static size_t decimate_minmax(const double* y, size_t n, size_t target, size_t* idx) {
+    size_t buckets = (target - 2) / 2, count = 0;
+    idx[count++] = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t lo = 1 + (n - 2) * b / buckets, hi = 1 + (n - 2) * (b + 1) / buckets;
+        if (lo >= hi) continue;
+        size_t imin = lo, imax = lo;
+        for (size_t i = lo + 1; i < hi; ++i) {
+            if (y[i] < y[imin]) imin = i;
+            if (y[i] > y[imax]) imax = i;
+        }
+        if (imin == imax) { idx[count++] = imin; continue; }
+        idx[count++] = imin < imax ? imin : imax;
+        idx[count++] = imin < imax ? imax : imin;
+    }
+    idx[count++] = n - 1;
+    return count;
+}
+
+static size_t decimate_lttb(const double* x, const double* y, size_t n, size_t target, size_t* idx) {
+    size_t buckets = target - 2, count = 0, a = 0;
+    idx[count++] = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t lo = 1 + (n - 2) * b / buckets, hi = 1 + (n - 2) * (b + 1) / buckets;
+        size_t nlo = hi, nhi = (b + 1 < buckets) ? 1 + (n - 2) * (b + 2) / buckets : n;
+        if (lo >= hi) continue;
+        double cx = 0.0, cy = 0.0; // Centroid of the next bucket
+        for (size_t i = nlo; i < nhi; ++i) { cx += x[i]; cy += y[i]; }
+        cx /= (double)(nhi - nlo); cy /= (double)(nhi - nlo);
+        size_t best = lo; double best_area = -1.0;
+        for (size_t i = lo; i < hi; ++i) {
+            double area = fabs((x[a] - cx) * (y[i] - y[a]) - (x[a] - x[i]) * (cy - y[a]));
+            if (area > best_area) { best_area = area; best = i; }
+        }
+        idx[count++] = a = best;
+    }
+    idx[count++] = n - 1;
+    return count;
+}
+
+// Plots y against x with lines and points
+WZ_DEF void plot_xy_runtime(Vector x, Vector y, const char* title) {
+    if (x.size != y.size) {
+        fprintf(stderr, "Error: X and Y vectors must have same size for plot_xy.\n");
+        return;
+    }
+    if (x.size == 0) {
+        fprintf(stderr, "Warning: nothing to plot for '%s' (empty vectors).\n", title);
+        return;
+    }
+    size_t target = plot_target_points(), *idx = NULL, count = x.size;
+    if (target > 0 && target < 4) target = 4;
+    if (target > 0 && x.size > target) {
+        idx = (size_t*)malloc(target * sizeof(size_t));
+        if (!idx) { fprintf(stderr, "Plot buffer allocation failed\n"); exit(1); }
+        count = (plot_decimate_method() == WZ_DECIMATE_LTTB) ? decimate_lttb(x.data, y.data, x.size, target, idx)
+                                                              : decimate_minmax(y.data, x.size, target, idx);
+    }
+    FILE* gp = open_gnuplot();
+    if (!gp) { free(idx); return; }
+    // A gnuplot that exits early (or is missing) must not kill the program with SIGPIPE
+    void (*old_sigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+    fprintf(gp, "plot '-' binary record=%zu format='%%float64%%float64' using 1:2 with linespoints title '%s'\n",
+            count, title);
+    double buf[2 * WZ_PLOT_CHUNK];
+    int ok = 1;
+    for (size_t i = 0; i < count && ok; i += WZ_PLOT_CHUNK) {
+        size_t n = (count - i < WZ_PLOT_CHUNK) ? count - i : WZ_PLOT_CHUNK;
+        for (size_t k = 0; k < n; ++k) {
+            size_t j = idx ? idx[i + k] : i + k;
+            buf[2 * k] = x.data[j]; buf[2 * k + 1] = y.data[j];
+        }
+        ok = fwrite(buf, 2 * sizeof(double), n, gp) == n;
+    }
+    if (!ok) fprintf(stderr, "Error writing plot data to gnuplot.\n");
+    pclose(gp);
+    free(idx);
+    signal(SIGPIPE, old_sigpipe);
+}
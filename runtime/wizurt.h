@@ -0,0 +1,144 @@
+#ifndef WIZURT_H
+#define WIZURT_H
+
+// WizuAll runtime library (libwizurt): the vector type and the helpers called
+// by programs generated by wizuallc. Link with -lwizurt -lm -pthread, and
+// -fopenmp when the library was built with OpenMP (the default).
+//
+// When WZ_INLINE_RUNTIME is defined (wizuallc --inline-runtime), the runtime
+// source is compiled into the program itself and every helper is static.
+
+#include <stdio.h>
+#include <stdlib.h> // For malloc, free, exit, strtod
+#include <string.h> // For memchr, memcpy, strcmp
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef WZ_INLINE_RUNTIME
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wunused-function" // Not every program uses every helper
+#endif
+#define WZ_API static
+#define WZ_DEF static
+#else
+#define WZ_API extern
+#define WZ_DEF
+#endif
+
+// --- WizuAll Data Structures ---
+typedef struct {
+    double* data;
+    size_t size;
+    int owned; // 1 if data is malloc'd and released by free_vector, 0 for views (e.g. cache mappings)
+} Vector;
+
+#define WZ_STREAM_BLOCK 4096 // Values folded per reduction kernel call
+
+// Running statistics of a streamed load_vector (see stream_columns_stats)
+typedef struct {
+    size_t n;           // Values seen
+    double sum, sum_c;  // Running sum and its Kahan compensation across blocks
+    double mean, m2;    // Running mean and sum of squared deviations from it
+    double min, max;    // +/-INFINITY until a non-NaN value is seen
+    size_t argmin, argmax; // (size_t)-1 until found
+    double block[WZ_STREAM_BLOCK];
+    size_t nblock;      // Values buffered in block[]
+} StreamStats;
+
+// Probe around one statement of a program built with wizuallc --profile
+typedef struct WzProbe {
+    struct WzProbe* parent; // Enclosing statement's probe (e.g. the while loop's)
+    int line;
+    unsigned long long start, nested; // Entry time and time in nested probes (ns)
+} WzProbe;
+
+// --- Configuration ---
+// Set at the start of the generated main() from the wizuallc options.
+WZ_API int wz_cache_enabled;    // --cache / --no-cache
+WZ_API int wz_compensated_sum;  // --compensated-sum
+WZ_API int wz_parallel;         // --parallel
+WZ_API size_t wz_plot_points;   // --plot-points (0 = no decimation)
+WZ_API int wz_plot_decimate;    // --plot-decimate (0 minmax, 1 lttb)
+
+// --- Profiling ---
+// Enables the per-line profile of a --profile program (source lines 1..lines);
+// it is printed at exit, to $WIZUALL_PROFILE if set, else to stderr
+WZ_API void wz_profile_start(const char* source, int lines);
+// Statement probes: enter before the statement, exit after it (monotonic clock)
+WZ_API void wz_probe_enter(WzProbe* p, int line);
+WZ_API void wz_probe_exit(WzProbe* p);
+
+// --- Vectors ---
+// Uninitialized vector, for results that are fully overwritten
+WZ_API Vector alloc_vector(size_t size);
+// Zero-filled vector
+WZ_API Vector create_vector(size_t size);
+// Size check failure of an element-wise vector operation (exits)
+WZ_API void vector_size_mismatch(int line, const char* name, size_t got, size_t expected);
+WZ_API void free_vector(Vector v);
+// Releases a variable's vector (generated code calls it after the last use and
+// before reassignment): its buffer goes back to the pool and the variable is left empty
+WZ_API void release_vector(Vector* v);
+// Result buffer for an element-wise assignment to *v: v's own buffer when it is
+// owned and already n long (each element is read before it is written), else a new one
+WZ_API Vector reuse_vector(const Vector* v, size_t n);
+// Stores a new value into a variable, releasing the old one unless its buffer was reused
+WZ_API void replace_vector(Vector* v, Vector r);
+// Length argument of create_vector, which must be a non-negative integer (exits otherwise)
+WZ_API size_t vector_length_arg(int line, double n);
+// Gives a view (a literal table or cache mapping) its own copy before an element is stored into it
+WZ_API void make_vector_writable(Vector* v);
+// Index check failure of v[i] (exits)
+WZ_API void vector_index_error(int line, const char* name, double index, size_t size);
+// Checked index of v[i]: i must lie in [0, size), and fractions are truncated.
+// wizuallc calls it for every access it cannot prove in bounds.
+static inline size_t wz_index(double i, size_t size, int line, const char* name) {
+    if (!(i >= 0 && i < (double)size)) vector_index_error(line, name, i, size); // NaN fails too
+    return (size_t)i;
+}
+// Number output: values are printed with the fewest digits that read back exactly
+#define WZ_DOUBLE_CHARS 32 // Buffer size for wz_format_double
+// Writes value as %.17g would, but with the shortest round-trip digits ("0.1", "1e+22"); returns the length
+WZ_API int wz_format_double(double value, char* out);
+WZ_API void print_vector_runtime(Vector v, const char* name);
+// Prints "<label> of <name>: <value>" (reduction built-ins used as statements)
+WZ_API void print_reduction_runtime(const char* label, const char* name, double value);
+
+// --- Data loading ---
+// Loads several columns of a whitespace/comma separated text file ("-" is stdin)
+// in one pass; served from the .wzcache sidecar when wz_cache_enabled
+WZ_API void load_vector_columns(const char* filename, int ncols, const int* columns, Vector** outs);
+WZ_API Vector load_vector_column(const char* filename, int column);
+
+// --- Reductions ---
+// Parallel threshold in elements (WIZUALL_PARALLEL_MIN overrides the built-in default)
+WZ_API size_t parallel_min_elements(void);
+WZ_API double sum_runtime(Vector v);
+WZ_API double average_runtime(Vector v);
+WZ_API double min_val_runtime(Vector v);
+WZ_API double max_val_runtime(Vector v);
+WZ_API double variance_runtime(Vector v);
+WZ_API double stddev_runtime(Vector v);
+WZ_API double argmin_runtime(Vector v);
+WZ_API double argmax_runtime(Vector v);
+
+// --- Streaming reductions ---
+WZ_API void stream_stats_reset(StreamStats* s);
+// Reduces columns of a text file in one streaming pass, without materializing them
+WZ_API void stream_columns_stats(const char* filename, int ncols, const int* columns, StreamStats** outs);
+WZ_API void stream_column_stats(const char* filename, int column, StreamStats* out);
+WZ_API double sum_stream(const StreamStats* s);
+WZ_API double average_stream(const StreamStats* s);
+WZ_API double min_val_stream(const StreamStats* s);
+WZ_API double max_val_stream(const StreamStats* s);
+WZ_API double variance_stream(const StreamStats* s);
+WZ_API double stddev_stream(const StreamStats* s);
+WZ_API double argmin_stream(const StreamStats* s);
+WZ_API double argmax_stream(const StreamStats* s);
+
+// --- Plotting ---
+WZ_API void plot_xy_runtime(Vector x, Vector y, const char* title);
+
+#endif // WIZURT_H
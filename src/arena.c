@@ -0,0 +1,62 @@
+#include "arena.h"
+#include <stdio.h>  // For fprintf
+#include <stdlib.h> // For malloc, free, exit
+#include <string.h> // For memcpy, strlen
+
+struct ArenaChunk {
+    ArenaChunk *next;
+    size_t size; // Usable bytes in data[]
+    size_t used;
+    _Alignas(max_align_t) unsigned char data[];
+};
+
+Arena compileArena = { NULL, 0, 0, 0 };
+
+void* arena_alloc(Arena *arena, size_t size) {
+    const size_t align = _Alignof(max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+    ArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t chunk_size = arena->chunk_size ? arena->chunk_size : ARENA_DEFAULT_CHUNK;
+        if (size > chunk_size / 4) chunk_size = size; // Large blocks get a chunk of their own
+        ArenaChunk *fresh = (ArenaChunk*)malloc(sizeof(ArenaChunk) + chunk_size);
+        if (!fresh) {
+            fprintf(stderr, "Memory allocation error (arena)\n");
+            exit(EXIT_FAILURE);
+        }
+        fresh->size = chunk_size;
+        fresh->used = 0;
+        if (chunk && chunk_size == size) { // Keep bump-allocating from the current chunk
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        } else {
+            fresh->next = chunk;
+            arena->head = fresh;
+        }
+        chunk = fresh;
+    }
+    void *p = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->allocations++;
+    arena->bytes += size;
+    return p;
+}
+
+char* arena_strdup(Arena *arena, const char *s) {
+    size_t len = strlen(s) + 1;
+    char *copy = (char*)arena_alloc(arena, len);
+    memcpy(copy, s, len);
+    return copy;
+}
+
+void arena_destroy(Arena *arena) {
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->allocations = 0;
+    arena->bytes = 0;
+}
@@ -1,7 +1,8 @@
 #include "ast.h"
+#include "arena.h"  // For compileArena
 #include <stdio.h>  // For printf, fprintf
-#include <stdlib.h> // For malloc, exit, realloc
-#include <string.h> // For strdup, free
+#include <stdlib.h> // For exit
+#include <string.h> // For memset, memcpy
 
 // Helper for printing indentation
 static void printIndent(int indent) {
@@ -12,16 +13,18 @@ static void printIndent(int indent) {
 
 // --- Node Constructors ---
 
-// Generic node allocation helper (internal)
+size_t ast_node_count = 0;
+
+// Generic node allocation helper (internal); nodes are bump-allocated from the compilation arena
 static Node* createNode(int lineno, NodeType type) {
-    Node* node = (Node*)malloc(sizeof(Node));
-    if (!node) {
-        fprintf(stderr, "Memory allocation error line %d\n", lineno);
-        exit(EXIT_FAILURE);
-    }
+    Node* node = (Node*)arena_alloc(&compileArena, sizeof(Node));
+    ast_node_count++;
     node->type = type;
     node->next = NULL;
     node->lineno = lineno;
+    node->isVector = 0;
+    node->length = -1;
+    node->lengthClass = 0;
     // Initialize data union members to NULL/0 where applicable
     memset(&node->data, 0, sizeof(node->data)); 
     return node;
@@ -48,19 +51,16 @@ Node* newNodeUnaryOp(int lineno, OpType op, Node* operand) {
     return node;
 }
 
-Node* newNodeID(int lineno, char* sval) {
+Node* newNodeID(int lineno, const char* sval) {
     Node* node = createNode(lineno, NODE_ID);
-    node->data.id.sval = strdup(sval); // Duplicate string to own it
-    if (!node->data.id.sval) {
-         fprintf(stderr, "Memory allocation error for ID string line %d\n", lineno);
-         exit(EXIT_FAILURE);
-    }
+    node->data.id.sval = sval; // Interned; shared with the lexer and symbol table
     return node;
 }
 
 Node* newNodeVec(int lineno, Node* firstElement) {
     Node* node = createNode(lineno, NODE_VEC);
     node->data.vec.count = 0;
+    node->data.vec.capacity = 0;
     node->data.vec.elements = NULL;
     if (firstElement) {
         return appendToVec(node, firstElement);
@@ -75,23 +75,22 @@ Node* appendToVec(Node* vecNode, Node* element) {
         // Maybe return vecNode or NULL depending on desired error handling
         return vecNode; 
     }
-    vecNode->data.vec.count++;
-    vecNode->data.vec.elements = (Node**)realloc(vecNode->data.vec.elements, vecNode->data.vec.count * sizeof(Node*));
-    if (!vecNode->data.vec.elements) {
-        fprintf(stderr, "Memory allocation error for vector elements line %d\n", vecNode->lineno);
-        exit(EXIT_FAILURE);
+    if (vecNode->data.vec.count == vecNode->data.vec.capacity) { // Grow geometrically (old array stays in the arena)
+        size_t capacity = vecNode->data.vec.capacity ? 2 * vecNode->data.vec.capacity : 4;
+        Node** elements = (Node**)arena_alloc(&compileArena, capacity * sizeof(Node*));
+        if (vecNode->data.vec.count) {
+            memcpy(elements, vecNode->data.vec.elements, vecNode->data.vec.count * sizeof(Node*));
+        }
+        vecNode->data.vec.elements = elements;
+        vecNode->data.vec.capacity = capacity;
     }
-    vecNode->data.vec.elements[vecNode->data.vec.count - 1] = element;
+    vecNode->data.vec.elements[vecNode->data.vec.count++] = element;
     return vecNode;
 }
 
-Node* newNodeAssign(int lineno, char* name, Node* value) {
+Node* newNodeAssign(int lineno, const char* name, Node* value) {
     Node* node = createNode(lineno, NODE_ASSIGN);
-    node->data.assignOp.name = strdup(name); 
-    if (!node->data.assignOp.name) {
-         fprintf(stderr, "Memory allocation error for assignment name line %d\n", lineno);
-         exit(EXIT_FAILURE);
-    }
+    node->data.assignOp.name = name; // Interned
     node->data.assignOp.value = value;
     return node;
 }
@@ -111,17 +110,28 @@ Node* newNodeWhile(int lineno, Node* condition, Node* body) {
     return node;
 }
 
-Node* newNodeFuncCall(int lineno, char* name, Node* args) {
+Node* newNodeFuncCall(int lineno, const char* name, Node* args) {
     Node* node = createNode(lineno, NODE_FUNC_CALL);
-    node->data.funcCall.name = strdup(name); // Own the name
-     if (!node->data.funcCall.name) {
-         fprintf(stderr, "Memory allocation error for function call name line %d\n", lineno);
-         exit(EXIT_FAILURE);
-    }
+    node->data.funcCall.name = name; // Interned
     node->data.funcCall.args = args; // Argument list head
     return node;
 }
 
+Node* newNodeIndex(int lineno, const char* name, Node* index) {
+    Node* node = createNode(lineno, NODE_INDEX);
+    node->data.index.name = name; // Interned
+    node->data.index.index = index;
+    return node;
+}
+
+Node* newNodeIndexAssign(int lineno, const char* name, Node* index, Node* value) {
+    Node* node = createNode(lineno, NODE_INDEX_ASSIGN);
+    node->data.index.name = name; // Interned
+    node->data.index.index = index;
+    node->data.index.value = value;
+    return node;
+}
+
 // --- AST Traversal/Utility Functions ---
 
 void printAST(Node* node, int indent) {
@@ -140,6 +150,12 @@ void printAST(Node* node, int indent) {
                 case OP_STAR: printf("*\n"); break;
                 case OP_MINUS: printf("-\n"); break;
                 case OP_DIV: printf("/\n"); break;
+                case OP_LT: printf("<\n"); break;
+                case OP_GT: printf(">\n"); break;
+                case OP_LE: printf("<=\n"); break;
+                case OP_GE: printf(">=\n"); break;
+                case OP_EQ: printf("==\n"); break;
+                case OP_NE: printf("!=\n"); break;
                 default: printf("Unknown\n");
             }
             printAST(node->data.binOp.left, indent + 1);
@@ -201,64 +217,18 @@ void printAST(Node* node, int indent) {
                 }
             }
             break;
+        case NODE_INDEX:
+            printf("Index: %s[]%s\n", node->data.index.name, node->data.index.inBounds ? " (in bounds)" : "");
+            printAST(node->data.index.index, indent + 1);
+            break;
+        case NODE_INDEX_ASSIGN:
+            printf("Element Assignment: %s[] =%s\n", node->data.index.name, node->data.index.inBounds ? " (in bounds)" : "");
+            printAST(node->data.index.index, indent + 1);
+            printAST(node->data.index.value, indent + 1);
+            break;
         default:
             printf("Unknown Node Type\n");
     }
     // NOTE: The list printing for statement lists is now handled *within* the IF/WHILE/Program printing
     // We don't call printAST(node->next, indent) at the end here anymore
 }
-
-void freeAST(Node* node) {
-    if (!node) return;
-    
-    // Recursively free children based on type
-    switch (node->type) {
-        case NODE_NUM:
-            break; // No children, no allocated data
-        case NODE_BINOP:
-            freeAST(node->data.binOp.left);
-            freeAST(node->data.binOp.right);
-            break;
-        case NODE_UNARYOP:
-            freeAST(node->data.unaryOp.operand);
-            break;
-        case NODE_ID:
-            free(node->data.id.sval); // Free the duplicated string
-            break;
-        case NODE_VEC:
-            // Free each element's AST, then the elements array itself
-            for (size_t i = 0; i < node->data.vec.count; i++) {
-                freeAST(node->data.vec.elements[i]);
-            }
-            free(node->data.vec.elements);
-            break;
-        case NODE_ASSIGN:
-            free(node->data.assignOp.name); 
-            freeAST(node->data.assignOp.value);
-            break;
-        case NODE_IF:
-            freeAST(node->data.ifStmt.condition);
-            freeAST(node->data.ifStmt.then_branch); // Free the list starting from the head
-            if (node->data.ifStmt.else_branch) {
-                freeAST(node->data.ifStmt.else_branch); // Free the list starting from the head
-            }
-            break;
-        case NODE_WHILE:
-            freeAST(node->data.whileStmt.condition);
-            freeAST(node->data.whileStmt.body); // Free the list starting from the head
-            break;
-        case NODE_FUNC_CALL:
-            free(node->data.funcCall.name);
-            freeAST(node->data.funcCall.args); // Free argument list
-            break;
-        default:
-             fprintf(stderr, "Warning: Trying to free unknown node type %d\n", node->type);
-             break;
-    }
-    
-    // Free the next node in the sequence *after* processing the current node's children
-    freeAST(node->next);
-
-    // Finally, free the node structure itself
-    free(node);
-} 
\ No newline at end of file
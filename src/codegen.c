@@ -1,19 +1,986 @@
 #include "codegen.h"
+#include "runtime.h"
+#include "semantic.h" // For sameVectorLength
 #include <stdio.h>
 #include <stdlib.h> // For exit
 #include <string.h> // For strcat and strcpy
+#include <math.h>   // For isnan, isinf, signbit
+
+typedef unsigned long LiveWord; // Word of a vector liveness bit set
+
+// Options of the current generateCode call
+static const CodegenOptions* currentOptions = NULL;
 
 // Forward declaration for the recursive expression generator
 static void generateExpressionCode(Node* node, FILE* outfile);
+static void generateVectorAssign(Node* node, FILE* outfile, const char* indentStr);
+static void generateStatementCode(Node* node, FILE* outfile, int indentLevel, const LiveWord* liveAfter);
+static int getLoadVectorArgs(Node* stmt, const char** filename, int* column);
+static int mentionsName(Node* node, const char* name);
+static int liveSlot(const char* name);
+
+// Fills buf with the indentation for the given level (4 spaces per indent level)
+static void makeIndent(char* buf, size_t size, int indentLevel) {
+    size_t len = 0;
+    for (int i = 0; i < indentLevel && len + 4 < size; ++i) {
+        memcpy(buf + len, "    ", 4);
+        len += 4;
+    }
+    buf[len] = '\0';
+}
+
+// Emits a double literal that reads back as exactly `value`: %.17g round-trips
+// every double, and a ".0" suffix keeps integral values from becoming int literals
+static void emitNumber(FILE* outfile, double value) {
+    char buf[40];
+    if (isnan(value)) { fprintf(outfile, "NAN"); return; }
+    if (isinf(value)) { fprintf(outfile, value < 0 ? "(-HUGE_VAL)" : "HUGE_VAL"); return; }
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    int isDouble = strpbrk(buf, ".e") != NULL;
+    fprintf(outfile, (value < 0 || signbit(value)) ? "(%s%s)" : "%s%s", buf, isDouble ? "" : ".0");
+}
+
+// Returns the C operator of a binary operator, with surrounding spaces
+static const char* binaryOperator(OpType op) {
+    switch (op) {
+        case OP_PLUS:  return " + ";
+        case OP_MINUS: return " - ";
+        case OP_STAR:  return " * ";
+        case OP_DIV:   return " / ";
+        case OP_LT:    return " < ";
+        case OP_GT:    return " > ";
+        case OP_LE:    return " <= ";
+        case OP_GE:    return " >= ";
+        case OP_EQ:    return " == ";
+        case OP_NE:    return " != ";
+        default:
+            fprintf(stderr, "Codegen Error: Unknown binary operator\n");
+            return " + ";
+    }
+}
+
+// Comparisons are emitted as ((double)(a < b)): 1.0 or 0.0 as in WizuAll, not
+// a C int (two of which would divide as integers)
+static int isComparison(OpType op) {
+    return op >= OP_LT && op <= OP_NE;
+}
+
+// --- Reduction Built-ins ---
 
-// Helper to generate C code for a single statement or expression
-static void generateStatementCode(Node* node, FILE* outfile, int indentLevel) {
+// Built-ins reducing a vector to a scalar. As statements they print the result;
+// inside expressions they evaluate to it.
+typedef struct {
+    const char* name;      // WizuAll name
+    const char* runtimeFn; // Runtime helper in the generated program
+    const char* streamFn;  // Same reduction over a streamed vector's running statistics
+    const char* label;     // Printed by the statement form
+} ReductionBuiltin;
+
+static const ReductionBuiltin reductionBuiltins[] = {
+    { "average",  "average_runtime",  "average_stream",  "Average" },
+    { "mean",     "average_runtime",  "average_stream",  "Mean" },
+    { "sum",      "sum_runtime",      "sum_stream",      "Sum" },
+    { "min_val",  "min_val_runtime",  "min_val_stream",  "Min value" },
+    { "max_val",  "max_val_runtime",  "max_val_stream",  "Max value" },
+    { "variance", "variance_runtime", "variance_stream", "Variance" },
+    { "stddev",   "stddev_runtime",   "stddev_stream",   "Std deviation" },
+    { "argmin",   "argmin_runtime",   "argmin_stream",   "Argmin" },
+    { "argmax",   "argmax_runtime",   "argmax_stream",   "Argmax" },
+};
+
+static const ReductionBuiltin* findReductionBuiltin(const char* name) {
+    for (size_t i = 0; i < sizeof(reductionBuiltins) / sizeof(reductionBuiltins[0]); ++i) {
+        if (strcmp(reductionBuiltins[i].name, name) == 0) return &reductionBuiltins[i];
+    }
+    return NULL;
+}
+
+// Emits the call computing a reduction of the vector variable `arg`
+static void generateReductionCall(const ReductionBuiltin* red, const char* arg, FILE* outfile) {
+    Symbol* sym = symtab_lookup(arg);
+    if (sym && sym->streamed) {
+        fprintf(outfile, "%s(&%s)", red->streamFn, arg);
+    } else {
+        fprintf(outfile, "%s(%s)", red->runtimeFn, arg);
+    }
+}
+
+// --- Vector Expression Helpers ---
+
+// Vectors whose every assigned value has the same statically known length of at
+// most this many elements live in a stack buffer instead of the heap
+#define WZ_STACK_VECTOR_MAX 64
+
+// Returns 1 if the expression evaluates to a Vector (as inferred by the semantic pass)
+static int isVectorExpr(Node* node) {
+    return node && node->isVector;
+}
+
+// Returns the length of the stack buffer backing vector variable `name`, 0 if it is heap-allocated
+static long stackVectorLength(const char* name) {
+    Symbol* sym = symtab_lookup(name);
+    if (!sym || sym->type != TYPE_VECTOR || sym->streamed) return 0;
+    return (sym->fixed_length > 0 && sym->fixed_length <= WZ_STACK_VECTOR_MAX) ? sym->fixed_length : 0;
+}
+
+// --- Streaming Reductions ---
+
+// Returns 1 if every mention of `name` in the node list is either the target of a
+// `name = load_vector(file, column);` statement or the sole argument of a reduction
+// built-in. Such a vector never needs its elements, only running statistics.
+static int onlyReducedUses(Node* node, const char* name) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_ID:
+                if (strcmp(node->data.id.sval, name) == 0) return 0;
+                break;
+            case NODE_BINOP:
+                if (!onlyReducedUses(node->data.binOp.left, name) || !onlyReducedUses(node->data.binOp.right, name)) return 0;
+                break;
+            case NODE_UNARYOP:
+                if (!onlyReducedUses(node->data.unaryOp.operand, name)) return 0;
+                break;
+            case NODE_VEC:
+                for (size_t i = 0; i < node->data.vec.count; ++i) {
+                    if (!onlyReducedUses(node->data.vec.elements[i], name)) return 0;
+                }
+                break;
+            case NODE_ASSIGN: {
+                const char* filename; int column;
+                if (strcmp(node->data.assignOp.name, name) == 0 && !getLoadVectorArgs(node, &filename, &column)) return 0;
+                if (!onlyReducedUses(node->data.assignOp.value, name)) return 0;
+                break;
+            }
+            case NODE_IF:
+                if (!onlyReducedUses(node->data.ifStmt.condition, name) || !onlyReducedUses(node->data.ifStmt.then_branch, name) ||
+                    !onlyReducedUses(node->data.ifStmt.else_branch, name)) return 0;
+                break;
+            case NODE_WHILE:
+                if (!onlyReducedUses(node->data.whileStmt.condition, name) || !onlyReducedUses(node->data.whileStmt.body, name)) return 0;
+                break;
+            case NODE_INDEX: case NODE_INDEX_ASSIGN:
+                if (strcmp(node->data.index.name, name) == 0) return 0;
+                if (!onlyReducedUses(node->data.index.index, name) || !onlyReducedUses(node->data.index.value, name)) return 0;
+                break;
+            case NODE_FUNC_CALL: {
+                Node* args = node->data.funcCall.args;
+                if (strcmp(node->data.funcCall.name, "load_vector") == 0) break; // Arguments are a file name and a number
+                if (findReductionBuiltin(node->data.funcCall.name) && args && args->type == NODE_ID && !args->next) break;
+                if (!onlyReducedUses(args, name)) return 0;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return 1;
+}
+
+// Marks the vectors that are only loaded and reduced as streamed: their loads
+// fold the file into running statistics instead of materializing the column
+static void markStreamedSymbols(Node* astRoot) {
+    for (Symbol* sym = globalSymTab ? globalSymTab->head : NULL; sym; sym = sym->next) {
+        sym->streamed = (sym->type == TYPE_VECTOR && onlyReducedUses(astRoot, sym->name));
+    }
+}
+
+// Returns 1 if stmt is a load_vector statement into a streamed vector
+static int isStreamedLoad(Node* stmt) {
+    const char* filename; int column;
+    if (!getLoadVectorArgs(stmt, &filename, &column)) return 0;
+    Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+    return sym && sym->streamed;
+}
+
+// Returns 1 if a load_vector call appears nested inside an expression
+static int containsLoadVector(Node* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_FUNC_CALL:
+            return strcmp(node->data.funcCall.name, "load_vector") == 0;
+        case NODE_BINOP:
+            return containsLoadVector(node->data.binOp.left) || containsLoadVector(node->data.binOp.right);
+        case NODE_UNARYOP:
+            return containsLoadVector(node->data.unaryOp.operand);
+        default:
+            return 0;
+    }
+}
+
+// Returns 1 if every element of the vector literal is a number
+static int isConstantLiteral(Node* node) {
+    for (size_t i = 0; i < node->data.vec.count; ++i) {
+        if (node->data.vec.elements[i]->type != NODE_NUM) return 0;
+    }
+    return 1;
+}
+
+// Emits the number elements of a vector literal as an initializer list, 8 per line
+// (other elements are left 0.0)
+static void emitLiteralTable(Node* node, FILE* outfile, const char* indentStr) {
+    for (size_t i = 0; i < node->data.vec.count; ++i) {
+        Node* element = node->data.vec.elements[i];
+        if (i == 0) fprintf(outfile, "{");
+        else if (i % 8 == 0) fprintf(outfile, ",\n%s        ", indentStr);
+        else fprintf(outfile, ", ");
+        emitNumber(outfile, element->type == NODE_NUM ? element->data.dval : 0.0);
+    }
+    fprintf(outfile, "}");
+}
+
+// Appends the ID nodes of the distinct vector variables referenced by an expression to *ids (grown as needed)
+static void collectVectorOperands(Node* node, Node*** ids, int* count, int* cap) {
     if (!node) return;
-    
-    // Print indentation
-    for (int i = 0; i < indentLevel; ++i) {
-        fprintf(outfile, "    "); // 4 spaces per indent level
+    switch (node->type) {
+        case NODE_ID:
+            if (isVectorExpr(node)) {
+                for (int i = 0; i < *count; ++i) {
+                    if (strcmp((*ids)[i]->data.id.sval, node->data.id.sval) == 0) return;
+                }
+                if (*count == *cap) {
+                    *cap = *cap ? 2 * *cap : 16;
+                    *ids = (Node**)realloc(*ids, *cap * sizeof(Node*));
+                    if (!*ids) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+                }
+                (*ids)[(*count)++] = node;
+            }
+            break;
+        case NODE_BINOP:
+            collectVectorOperands(node->data.binOp.left, ids, count, cap);
+            collectVectorOperands(node->data.binOp.right, ids, count, cap);
+            break;
+        case NODE_UNARYOP:
+            collectVectorOperands(node->data.unaryOp.operand, ids, count, cap);
+            break;
+        default:
+            break;
+    }
+}
+
+// Hoists scalar subexpressions of a vector expression into constants evaluated
+// once before the fused loop, and vector literals into local arrays.
+// Leaves (numbers, scalar IDs) are left in place.
+static void hoistScalarOperands(Node* node, FILE* outfile, const char* indentStr, int* hoisted) {
+    if (!node || node->type == NODE_NUM || node->type == NODE_ID) return;
+    if (node->type == NODE_VEC) {
+        if (node->data.vec.count == 0) { // Never indexed: the loop runs zero times
+            fprintf(outfile, "%s    const double* _wz_s%d = NULL;\n", indentStr, (*hoisted)++);
+            return;
+        }
+        if (isConstantLiteral(node)) { // Read-only table, no stores at run time
+            fprintf(outfile, "%s    static const double _wz_s%d[%zu] = ", indentStr, (*hoisted)++, node->data.vec.count);
+            emitLiteralTable(node, outfile, indentStr);
+            fprintf(outfile, ";\n");
+            return;
+        }
+        fprintf(outfile, "%s    const double _wz_s%d[%zu] = {", indentStr, (*hoisted)++, node->data.vec.count);
+        for (size_t i = 0; i < node->data.vec.count; ++i) {
+            if (i) fprintf(outfile, ", ");
+            generateExpressionCode(node->data.vec.elements[i], outfile);
+        }
+        fprintf(outfile, "};\n");
+        return;
+    }
+    if (!isVectorExpr(node)) {
+        fprintf(outfile, "%s    const double _wz_s%d = ", indentStr, (*hoisted)++);
+        generateExpressionCode(node, outfile);
+        fprintf(outfile, ";\n");
+        return;
+    }
+    if (node->type == NODE_BINOP) {
+        hoistScalarOperands(node->data.binOp.left, outfile, indentStr, hoisted);
+        hoistScalarOperands(node->data.binOp.right, outfile, indentStr, hoisted);
+    } else if (node->type == NODE_UNARYOP) {
+        hoistScalarOperands(node->data.unaryOp.operand, outfile, indentStr, hoisted);
     }
+}
+
+// Emits the per-element C expression for a vector expression at index _wz_i.
+// Must visit nodes in the same order as hoistScalarOperands.
+static void generateElementCode(Node* node, FILE* outfile, int* hoisted) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_NUM:
+            emitNumber(outfile, node->data.dval);
+            break;
+        case NODE_ID:
+            if (isVectorExpr(node)) {
+                fprintf(outfile, "_wz_p_%s[_wz_i]", node->data.id.sval);
+            } else {
+                generateExpressionCode(node, outfile);
+            }
+            break;
+        case NODE_VEC:
+            fprintf(outfile, "_wz_s%d[_wz_i]", (*hoisted)++);
+            break;
+        case NODE_BINOP:
+            if (!isVectorExpr(node)) {
+                fprintf(outfile, "_wz_s%d", (*hoisted)++);
+                break;
+            }
+            fprintf(outfile, isComparison(node->data.binOp.op) ? "((double)(" : "(");
+            generateElementCode(node->data.binOp.left, outfile, hoisted);
+            fprintf(outfile, "%s", binaryOperator(node->data.binOp.op));
+            generateElementCode(node->data.binOp.right, outfile, hoisted);
+            fprintf(outfile, isComparison(node->data.binOp.op) ? "))" : ")");
+            break;
+        case NODE_UNARYOP:
+            if (!isVectorExpr(node)) {
+                fprintf(outfile, "_wz_s%d", (*hoisted)++);
+                break;
+            }
+            fprintf(outfile, "(-");
+            generateElementCode(node->data.unaryOp.operand, outfile, hoisted);
+            fprintf(outfile, ")");
+            break;
+        default:
+            fprintf(outfile, "_wz_s%d", (*hoisted)++);
+            break;
+    }
+}
+
+// Generates a single fused loop for `name = <vector expression>;`.
+// The whole expression tree is evaluated element by element, so no
+// intermediate Vector is materialized per operator; only the result is allocated
+// (or written straight into the target's stack buffer).
+// Operands whose length the semantic pass proved equal to the result's are not
+// size-checked, and a statically known length becomes a constant trip count.
+static void generateVectorAssign(Node* node, FILE* outfile, const char* indentStr) {
+    Node* value = node->data.assignOp.value;
+    const char* target = node->data.assignOp.name;
+    Node** operands = NULL;
+    int operandCount = 0, operandCap = 0;
+    collectVectorOperands(value, &operands, &operandCount, &operandCap);
+    if ((operandCount == 0 && value->length < 0) || containsLoadVector(value)) {
+        fprintf(outfile, "/* Codegen Error: Unsupported vector expression on line %d */\n", node->lineno);
+        free(operands);
+        return;
+    }
+
+    fprintf(outfile, "{\n");
+    Node* reference = NULL; // Operand whose size is the trip count
+    if (value->length >= 0) {
+        fprintf(outfile, "%s    const size_t _wz_n = %ld;\n", indentStr, value->length);
+    } else {
+        reference = operands[0];
+        fprintf(outfile, "%s    size_t _wz_n = %s.size;\n", indentStr, reference->data.id.sval);
+    }
+    for (int i = 0; i < operandCount; ++i) {
+        const char* name = operands[i]->data.id.sval;
+        if (operands[i] == reference || sameVectorLength(operands[i], reference ? reference : value)) continue;
+        fprintf(outfile, "%s    if (%s.size != _wz_n) vector_size_mismatch(%d, \"%s\", %s.size, _wz_n);\n",
+                indentStr, name, node->lineno, name, name);
+    }
+    int hoisted = 0;
+    hoistScalarOperands(value, outfile, indentStr, &hoisted);
+    int targetIsOperand = 0;
+    for (int i = 0; i < operandCount; ++i) {
+        const char* name = operands[i]->data.id.sval;
+        fprintf(outfile, "%s    const double* _wz_p_%s = %s.data;\n", indentStr, name, name);
+        if (strcmp(name, target) == 0) targetIsOperand = 1;
+    }
+    long stackLength = stackVectorLength(target);
+    if (stackLength > 0) { // Same index in and out, so updating in place is safe (but not restrict)
+        fprintf(outfile, "%s    double*%s _wz_out = _wz_buf_%s;\n", indentStr, targetIsOperand ? "" : " restrict", target);
+    } else { // Reuses the target's buffer when it has the right size
+        fprintf(outfile, "%s    Vector _wz_r = reuse_vector(&%s, _wz_n);\n", indentStr, target);
+        fprintf(outfile, "%s    double*%s _wz_out = _wz_r.data;\n", indentStr, targetIsOperand ? "" : " restrict");
+        if (currentOptions->parallel) { // Split across threads above the runtime size threshold
+            fprintf(outfile, "%s    #pragma omp parallel for schedule(static) if(_wz_n >= parallel_min_elements())\n", indentStr);
+        }
+    }
+    fprintf(outfile, "%s    for (size_t _wz_i = 0; _wz_i < _wz_n; ++_wz_i) {\n", indentStr);
+    fprintf(outfile, "%s        _wz_out[_wz_i] = ", indentStr);
+    hoisted = 0;
+    generateElementCode(value, outfile, &hoisted);
+    fprintf(outfile, ";\n");
+    fprintf(outfile, "%s    }\n", indentStr);
+    if (stackLength > 0) { // The vector may have been a literal view since the last assignment
+        fprintf(outfile, "%s    %s.data = _wz_buf_%s; %s.size = _wz_n;\n", indentStr, target, target, target);
+    } else {
+        fprintf(outfile, "%s    replace_vector(&%s, _wz_r);\n", indentStr, target);
+    }
+    fprintf(outfile, "%s}\n", indentStr);
+    free(operands);
+}
+
+// Longest non-constant vector literal stored element by element
+#define LITERAL_STORE_MAX 8
+
+// Generates `name = [e1, e2, ...];`. A literal of numbers becomes a static const
+// table in read-only data and the variable a non-owning view of it: nothing is
+// allocated or copied at run time. Elements are never written through a Vector,
+// so the view's data pointer may drop the const. Other literals are stored
+// into one preallocated buffer (the stack buffer, if any): element by element, or
+// for longer literals as a copy of a read-only table patched with the computed elements.
+static void generateLiteralAssign(Node* node, FILE* outfile, const char* indentStr) {
+    Node* value = node->data.assignOp.value;
+    const char* target = node->data.assignOp.name;
+    size_t count = value->data.vec.count;
+    fprintf(outfile, "{\n");
+    if (isConstantLiteral(value)) {
+        if (count == 0) {
+            if (liveSlot(target) >= 0) fprintf(outfile, "%s    release_vector(&%s);\n", indentStr, target);
+            fprintf(outfile, "%s    %s.data = NULL; %s.size = 0; %s.owned = 0;\n", indentStr, target, target, target);
+        } else {
+            fprintf(outfile, "%s    static const double _wz_lit[%zu] = ", indentStr, count);
+            emitLiteralTable(value, outfile, indentStr);
+            fprintf(outfile, ";\n");
+            if (liveSlot(target) >= 0) fprintf(outfile, "%s    release_vector(&%s);\n", indentStr, target);
+            fprintf(outfile, "%s    %s.data = (double*)_wz_lit; %s.size = %zu; %s.owned = 0;\n", indentStr, target, target, count, target);
+        }
+        fprintf(outfile, "%s}\n", indentStr);
+        return;
+    }
+    int stack = stackVectorLength(target) > 0;
+    // Elements reading the target are evaluated into a temporary before its stack buffer is overwritten
+    int selfReference = 0;
+    for (size_t i = 0; i < count && stack; ++i) {
+        if (mentionsName(value->data.vec.elements[i], target)) selfReference = 1;
+    }
+    if (stack && !selfReference) {
+        fprintf(outfile, "%s    double* _wz_out = _wz_buf_%s;\n", indentStr, target);
+    } else if (stack) {
+        fprintf(outfile, "%s    double _wz_out[%zu];\n", indentStr, count);
+    } else {
+        fprintf(outfile, "%s    Vector _wz_r = alloc_vector(%zu);\n", indentStr, count);
+        fprintf(outfile, "%s    double* _wz_out = _wz_r.data;\n", indentStr);
+    }
+    int table = count > LITERAL_STORE_MAX;
+    if (table) {
+        fprintf(outfile, "%s    static const double _wz_lit[%zu] = ", indentStr, count);
+        emitLiteralTable(value, outfile, indentStr);
+        fprintf(outfile, ";\n");
+        fprintf(outfile, "%s    memcpy(_wz_out, _wz_lit, sizeof(_wz_lit));\n", indentStr);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (table && value->data.vec.elements[i]->type == NODE_NUM) continue;
+        fprintf(outfile, "%s    _wz_out[%zu] = ", indentStr, i);
+        generateExpressionCode(value->data.vec.elements[i], outfile);
+        fprintf(outfile, ";\n");
+    }
+    if (stack) {
+        if (selfReference) fprintf(outfile, "%s    memcpy(_wz_buf_%s, _wz_out, sizeof(_wz_out));\n", indentStr, target);
+        fprintf(outfile, "%s    %s.data = _wz_buf_%s; %s.size = %zu; %s.owned = 0;\n", indentStr, target, target, target, count, target);
+    } else {
+        fprintf(outfile, "%s    replace_vector(&%s, _wz_r);\n", indentStr, target);
+    }
+    fprintf(outfile, "%s}\n", indentStr);
+}
+
+// --- Element Access ---
+// v[i] indexes v.data directly where the semantic pass proved i in bounds (see
+// Index Ranges in semantic.c), and through wz_index, which checks it, elsewhere.
+// A store first makes sure v owns its buffer: a literal table or cache mapping
+// is copied once, and a stack vector is copied back into its buffer. For a
+// while loop that never reassigns v, that check is hoisted in front of the loop.
+
+#define WRITABLE_HOIST_MAX 64
+
+static const char* writableVectors[WRITABLE_HOIST_MAX]; // Made writable in front of the enclosing loops
+static int writableCount = 0;
+
+static int isWritable(const char* name) {
+    for (int i = 0; i < writableCount; ++i) {
+        if (writableVectors[i] == name) return 1; // Interned
+    }
+    return 0;
+}
+
+// Returns 1 if the statement list assigns a whole new value to `name` anywhere
+static int assignsName(Node* stmt, const char* name) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN:
+                if (strcmp(stmt->data.assignOp.name, name) == 0) return 1;
+                break;
+            case NODE_IF:
+                if (assignsName(stmt->data.ifStmt.then_branch, name) || assignsName(stmt->data.ifStmt.else_branch, name)) return 1;
+                break;
+            case NODE_WHILE:
+                if (assignsName(stmt->data.whileStmt.body, name)) return 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+// Emits the statement (and indentation for the next) making vector `name` safe to store into
+static void emitMakeWritable(const char* name, FILE* outfile, const char* indentStr) {
+    if (stackVectorLength(name) > 0) {
+        fprintf(outfile, "if (%s.data != _wz_buf_%s) { memcpy(_wz_buf_%s, %s.data, %s.size * sizeof(double)); %s.data = _wz_buf_%s; }\n%s",
+                name, name, name, name, name, name, name, indentStr);
+    } else {
+        fprintf(outfile, "if (!%s.owned) make_vector_writable(&%s);\n%s", name, name, indentStr);
+    }
+}
+
+// Hoists the writability checks of the vectors stored into (but never reassigned) in a loop body
+static void hoistWritable(Node* stmt, Node* body, FILE* outfile, const char* indentStr) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_INDEX_ASSIGN: {
+                const char* name = stmt->data.index.name;
+                if (isWritable(name) || writableCount == WRITABLE_HOIST_MAX || assignsName(body, name)) break;
+                emitMakeWritable(name, outfile, indentStr);
+                writableVectors[writableCount++] = name;
+                break;
+            }
+            case NODE_IF:
+                hoistWritable(stmt->data.ifStmt.then_branch, body, outfile, indentStr);
+                hoistWritable(stmt->data.ifStmt.else_branch, body, outfile, indentStr);
+                break;
+            case NODE_WHILE:
+                hoistWritable(stmt->data.whileStmt.body, body, outfile, indentStr);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Emits the element v[i], for a read or a store
+static void generateElementAccess(Node* node, FILE* outfile) {
+    const char* name = node->data.index.name;
+    Node* index = node->data.index.index;
+    if (node->data.index.inBounds && index->type == NODE_NUM) {
+        fprintf(outfile, "%s.data[%ld]", name, (long)index->data.dval);
+    } else if (node->data.index.inBounds) {
+        fprintf(outfile, "%s.data[(size_t)", name);
+        generateExpressionCode(index, outfile);
+        fprintf(outfile, "]");
+    } else {
+        fprintf(outfile, "%s.data[wz_index(", name);
+        generateExpressionCode(index, outfile);
+        fprintf(outfile, ", %s.size, %d, \"%s\")]", name, node->lineno, name);
+    }
+}
+
+// Generates `name[i] = value;`
+static void generateIndexAssign(Node* node, FILE* outfile, const char* indentStr) {
+    if (!isWritable(node->data.index.name)) emitMakeWritable(node->data.index.name, outfile, indentStr);
+    generateElementAccess(node, outfile);
+    fprintf(outfile, " = ");
+    generateExpressionCode(node->data.index.value, outfile);
+    fprintf(outfile, ";\n");
+}
+
+// Generates `name = create_vector(n);`: zeros, in the target's buffer when it has the right size
+static void generateCreateAssign(Node* node, FILE* outfile, const char* indentStr) {
+    Node* value = node->data.assignOp.value;
+    const char* target = node->data.assignOp.name;
+    long stackLength = stackVectorLength(target);
+    if (stackLength > 0) { // n is known to be the buffer's length
+        fprintf(outfile, "memset(_wz_buf_%s, 0, sizeof(_wz_buf_%s)); %s.data = _wz_buf_%s; %s.size = %ld; %s.owned = 0;\n",
+                target, target, target, target, target, stackLength, target);
+        return;
+    }
+    fprintf(outfile, "{\n");
+    if (value->length >= 0) {
+        fprintf(outfile, "%s    const size_t _wz_n = %ld;\n", indentStr, value->length);
+    } else {
+        fprintf(outfile, "%s    const size_t _wz_n = vector_length_arg(%d, ", indentStr, node->lineno);
+        generateExpressionCode(value->data.funcCall.args, outfile);
+        fprintf(outfile, ");\n");
+    }
+    fprintf(outfile, "%s    Vector _wz_r = reuse_vector(&%s, _wz_n);\n", indentStr, target);
+    fprintf(outfile, "%s    if (_wz_n > 0) memset(_wz_r.data, 0, _wz_n * sizeof(double));\n", indentStr);
+    fprintf(outfile, "%s    replace_vector(&%s, _wz_r);\n", indentStr, target);
+    fprintf(outfile, "%s}\n", indentStr);
+}
+
+// --- Vector Liveness ---
+// Heap vectors are released right after their last use, so their buffers go
+// back to the runtime pool (and are reused by the next allocation of the same
+// size) instead of leaking when the variable is reassigned, e.g. in a loop.
+// Liveness is computed backwards over the structured AST; a loop's live-in set
+// is iterated to a fixpoint, since the body also runs after itself.
+
+#define LIVE_WORD_BITS (8 * sizeof(LiveWord))
+
+static int liveSlotCount = 0;  // Tracked vectors (Symbol live_slot 0..liveSlotCount-1)
+static size_t liveWords = 1;   // Words per live set
+static unsigned int* slotStamp = NULL; // Per slot: last mention scan that saw it
+static unsigned int mentionStamp = 0;
+
+static LiveWord* newLiveSet(const LiveWord* copy) {
+    LiveWord* set = (LiveWord*)calloc(liveWords, sizeof(LiveWord));
+    if (!set) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+    if (copy) memcpy(set, copy, liveWords * sizeof(LiveWord));
+    return set;
+}
+
+static int liveSlot(const char* name) {
+    Symbol* sym = symtab_lookup(name);
+    return sym ? sym->live_slot : -1;
+}
+
+static void liveAdd(LiveWord* set, int slot) { set[slot / LIVE_WORD_BITS] |= (LiveWord)1 << (slot % LIVE_WORD_BITS); }
+static void liveRemove(LiveWord* set, int slot) { set[slot / LIVE_WORD_BITS] &= ~((LiveWord)1 << (slot % LIVE_WORD_BITS)); }
+static int liveHas(const LiveWord* set, int slot) { return (set[slot / LIVE_WORD_BITS] >> (slot % LIVE_WORD_BITS)) & 1; }
+
+// Adds the tracked vectors read by an expression
+static void addReads(Node* node, LiveWord* live) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_ID: {
+            int slot = liveSlot(node->data.id.sval);
+            if (slot >= 0) liveAdd(live, slot);
+            break;
+        }
+        case NODE_BINOP:
+            addReads(node->data.binOp.left, live);
+            addReads(node->data.binOp.right, live);
+            break;
+        case NODE_UNARYOP:
+            addReads(node->data.unaryOp.operand, live);
+            break;
+        case NODE_VEC:
+            for (size_t i = 0; i < node->data.vec.count; ++i) addReads(node->data.vec.elements[i], live);
+            break;
+        case NODE_FUNC_CALL:
+            for (Node* arg = node->data.funcCall.args; arg; arg = arg->next) addReads(arg, live);
+            break;
+        case NODE_INDEX: case NODE_INDEX_ASSIGN: { // A store updates the existing buffer, so it reads the vector too
+            int slot = liveSlot(node->data.index.name);
+            if (slot >= 0) liveAdd(live, slot);
+            addReads(node->data.index.index, live);
+            addReads(node->data.index.value, live);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void liveBeforeList(Node* first, LiveWord* live);
+
+// Turns the live set after a while loop into the set live at its head
+static void liveBeforeLoop(Node* loop, LiveWord* live) {
+    LiveWord* exit = newLiveSet(live); // Leaving the loop evaluates the condition
+    addReads(loop->data.whileStmt.condition, exit);
+    LiveWord* head = newLiveSet(exit);
+    LiveWord* body = newLiveSet(NULL);
+    for (;;) {
+        memcpy(body, head, liveWords * sizeof(LiveWord));
+        liveBeforeList(loop->data.whileStmt.body, body);
+        for (size_t w = 0; w < liveWords; ++w) body[w] |= exit[w];
+        if (memcmp(body, head, liveWords * sizeof(LiveWord)) == 0) break;
+        memcpy(head, body, liveWords * sizeof(LiveWord));
+    }
+    memcpy(live, head, liveWords * sizeof(LiveWord));
+    free(body); free(head); free(exit);
+}
+
+// Turns the live set after a statement into the set live before it
+static void liveBeforeStatement(Node* stmt, LiveWord* live) {
+    switch (stmt->type) {
+        case NODE_ASSIGN: {
+            int slot = liveSlot(stmt->data.assignOp.name);
+            if (slot >= 0) liveRemove(live, slot);
+            addReads(stmt->data.assignOp.value, live);
+            break;
+        }
+        case NODE_IF: {
+            LiveWord* other = newLiveSet(live);
+            liveBeforeList(stmt->data.ifStmt.then_branch, live);
+            liveBeforeList(stmt->data.ifStmt.else_branch, other);
+            for (size_t w = 0; w < liveWords; ++w) live[w] |= other[w];
+            free(other);
+            addReads(stmt->data.ifStmt.condition, live);
+            break;
+        }
+        case NODE_WHILE:
+            liveBeforeLoop(stmt, live);
+            break;
+        default:
+            addReads(stmt, live);
+            break;
+    }
+}
+
+static void liveBeforeList(Node* first, LiveWord* live) {
+    size_t count = 0;
+    for (Node* s = first; s; s = s->next) count++;
+    if (count == 0) return;
+    Node** stmts = (Node**)malloc(count * sizeof(Node*));
+    if (!stmts) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+    count = 0;
+    for (Node* s = first; s; s = s->next) stmts[count++] = s;
+    while (count > 0) liveBeforeStatement(stmts[--count], live);
+    free(stmts);
+}
+
+// Appends the tracked vectors mentioned anywhere in a statement (read, assigned
+// or inside nested blocks) that are dead after it; each is listed once
+static void collectReleases(Node* node, int followNext, const LiveWord* liveAfter, const char*** names, size_t* count, size_t* cap) {
+    for (; node; node = followNext ? node->next : NULL) {
+        const char* name = NULL;
+        switch (node->type) {
+            case NODE_ID: name = node->data.id.sval; break;
+            case NODE_ASSIGN:
+                name = node->data.assignOp.name;
+                collectReleases(node->data.assignOp.value, 0, liveAfter, names, count, cap);
+                break;
+            case NODE_BINOP:
+                collectReleases(node->data.binOp.left, 0, liveAfter, names, count, cap);
+                collectReleases(node->data.binOp.right, 0, liveAfter, names, count, cap);
+                break;
+            case NODE_UNARYOP:
+                collectReleases(node->data.unaryOp.operand, 0, liveAfter, names, count, cap);
+                break;
+            case NODE_VEC:
+                for (size_t i = 0; i < node->data.vec.count; ++i) {
+                    collectReleases(node->data.vec.elements[i], 0, liveAfter, names, count, cap);
+                }
+                break;
+            case NODE_IF:
+                collectReleases(node->data.ifStmt.condition, 0, liveAfter, names, count, cap);
+                collectReleases(node->data.ifStmt.then_branch, 1, liveAfter, names, count, cap);
+                collectReleases(node->data.ifStmt.else_branch, 1, liveAfter, names, count, cap);
+                break;
+            case NODE_WHILE:
+                collectReleases(node->data.whileStmt.condition, 0, liveAfter, names, count, cap);
+                collectReleases(node->data.whileStmt.body, 1, liveAfter, names, count, cap);
+                break;
+            case NODE_FUNC_CALL:
+                collectReleases(node->data.funcCall.args, 1, liveAfter, names, count, cap);
+                break;
+            case NODE_INDEX: case NODE_INDEX_ASSIGN:
+                name = node->data.index.name;
+                collectReleases(node->data.index.index, 0, liveAfter, names, count, cap);
+                collectReleases(node->data.index.value, 0, liveAfter, names, count, cap);
+                break;
+            default:
+                break;
+        }
+        int slot = name ? liveSlot(name) : -1;
+        if (slot < 0 || slotStamp[slot] == mentionStamp || liveHas(liveAfter, slot)) continue;
+        slotStamp[slot] = mentionStamp;
+        if (*count == *cap) {
+            *cap = *cap ? 2 * *cap : 64;
+            *names = (const char**)realloc(*names, *cap * sizeof(const char*));
+            if (!*names) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+        }
+        (*names)[(*count)++] = name;
+    }
+}
+
+// Numbers the vectors that can own a heap buffer: not streamed, not in a stack buffer
+static void assignLiveSlots(void) {
+    liveSlotCount = 0;
+    for (Symbol* sym = globalSymTab ? globalSymTab->head : NULL; sym; sym = sym->next) {
+        int tracked = sym->type == TYPE_VECTOR && !sym->streamed && stackVectorLength(sym->name) == 0;
+        sym->live_slot = tracked ? liveSlotCount++ : -1;
+    }
+    liveWords = liveSlotCount > 0 ? (liveSlotCount + LIVE_WORD_BITS - 1) / LIVE_WORD_BITS : 1;
+    slotStamp = (unsigned int*)calloc(liveSlotCount > 0 ? liveSlotCount : 1, sizeof(unsigned int));
+    if (!slotStamp) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+    mentionStamp = 0;
+}
+
+// --- load_vector Batching ---
+
+// Maximum number of following statements searched for loads of the same file
+#define LOAD_BATCH_WINDOW 32
+
+// Returns 1 if stmt is `name = load_vector(file_id, column);` with valid arguments,
+// filling in the filename (as emitted) and column index
+static int getLoadVectorArgs(Node* stmt, const char** filename, int* column) {
+    if (!stmt || stmt->type != NODE_ASSIGN) return 0;
+    Node* value = stmt->data.assignOp.value;
+    if (!value || value->type != NODE_FUNC_CALL || strcmp(value->data.funcCall.name, "load_vector") != 0) return 0;
+    Node* filename_arg = value->data.funcCall.args;
+    Node* column_arg = filename_arg ? filename_arg->next : NULL;
+    if (!filename_arg || filename_arg->type != NODE_ID /* Allow string literals later */ ||
+        !column_arg || column_arg->type != NODE_NUM || column_arg->next) return 0;
+    *filename = filename_arg->data.id.sval; // Use ID name as filename
+    // The identifier `stdin` reads from standard input
+    if (strcmp(*filename, "stdin") == 0) *filename = "-";
+    *column = (int)column_arg->data.dval;
+    return 1;
+}
+
+// Returns 1 if the identifier `name` appears anywhere in the node list (statements or arguments
+// linked via next), including nested expressions and statement lists
+static int mentionsName(Node* node, const char* name) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_ID:
+                if (strcmp(node->data.id.sval, name) == 0) return 1;
+                break;
+            case NODE_BINOP:
+                if (mentionsName(node->data.binOp.left, name) || mentionsName(node->data.binOp.right, name)) return 1;
+                break;
+            case NODE_UNARYOP:
+                if (mentionsName(node->data.unaryOp.operand, name)) return 1;
+                break;
+            case NODE_VEC:
+                for (size_t i = 0; i < node->data.vec.count; ++i) {
+                    if (mentionsName(node->data.vec.elements[i], name)) return 1;
+                }
+                break;
+            case NODE_ASSIGN:
+                if (strcmp(node->data.assignOp.name, name) == 0 || mentionsName(node->data.assignOp.value, name)) return 1;
+                break;
+            case NODE_IF:
+                if (mentionsName(node->data.ifStmt.condition, name) || mentionsName(node->data.ifStmt.then_branch, name) ||
+                    mentionsName(node->data.ifStmt.else_branch, name)) return 1;
+                break;
+            case NODE_WHILE:
+                if (mentionsName(node->data.whileStmt.condition, name) || mentionsName(node->data.whileStmt.body, name)) return 1;
+                break;
+            case NODE_FUNC_CALL:
+                if (mentionsName(node->data.funcCall.args, name)) return 1;
+                break;
+            case NODE_INDEX: case NODE_INDEX_ASSIGN:
+                if (strcmp(node->data.index.name, name) == 0 || mentionsName(node->data.index.index, name) ||
+                    mentionsName(node->data.index.value, name)) return 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+// Emits one load_vector_columns call filling every load of the batch in a single file scan
+// (stream_columns_stats for a batch of streamed vectors)
+static void generateBatchedLoad(Node** batch, int count, const char* filename, FILE* outfile, const char* indentStr) {
+    int streamed = isStreamedLoad(batch[0]);
+    fprintf(outfile, "{\n");
+    fprintf(outfile, "%s    static const int _wz_cols[] = {", indentStr);
+    for (int i = 0; i < count; ++i) {
+        const char* unused; int column;
+        getLoadVectorArgs(batch[i], &unused, &column);
+        fprintf(outfile, "%s%d", i ? ", " : "", column);
+    }
+    fprintf(outfile, "};\n");
+    fprintf(outfile, "%s    %s* _wz_outs[] = {", indentStr, streamed ? "StreamStats" : "Vector");
+    for (int i = 0; i < count; ++i) {
+        fprintf(outfile, "%s&%s", i ? ", " : "", batch[i]->data.assignOp.name);
+    }
+    fprintf(outfile, "};\n");
+    for (int i = 0; i < count; ++i) {
+        if (liveSlot(batch[i]->data.assignOp.name) >= 0) {
+            fprintf(outfile, "%s    release_vector(&%s);\n", indentStr, batch[i]->data.assignOp.name);
+        }
+    }
+    fprintf(outfile, "%s    %s(\"%s\", %d, _wz_cols, _wz_outs); /* lines", indentStr,
+            streamed ? "stream_columns_stats" : "load_vector_columns", filename, count);
+    for (int i = 0; i < count; ++i) fprintf(outfile, " %d", batch[i]->lineno);
+    fprintf(outfile, " */\n");
+    fprintf(outfile, "%s}\n", indentStr);
+}
+
+// Generates a statement list. Loads of the same file are batched into one scan:
+// a later `v = load_vector(f, c);` joins an earlier load of f when v is not
+// referenced by any statement in between (loads read no variables, so moving
+// it up cannot change the result) and is not already a target of the batch.
+// Streamed and materialized loads are batched separately.
+// liveOut holds the vectors live after the list; every other vector the list
+// mentions is released right after the statement that last mentions it.
+static void generateStatementList(Node* first, FILE* outfile, int indentLevel, const LiveWord* liveOut) {
+    size_t count = 0, cap = 16;
+    Node** stmts = (Node**)malloc(cap * sizeof(Node*));
+    char* done = NULL;
+    if (!stmts) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+    for (Node* s = first; s; s = s->next) {
+        if (count == cap) {
+            cap *= 2;
+            stmts = (Node**)realloc(stmts, cap * sizeof(Node*));
+            if (!stmts) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+        }
+        stmts[count++] = s;
+    }
+    done = (char*)calloc(count ? count : 1, 1);
+    // Per statement: the live set after it (blocks only), and the vectors to release after it
+    // (releaseNames[releaseStart[i] .. releaseStart[i + 1]), collected backwards)
+    LiveWord** liveAfter = (LiveWord**)malloc((count ? count : 1) * sizeof(LiveWord*));
+    size_t* releaseStart = (size_t*)malloc((count + 1) * sizeof(size_t));
+    const char** releaseNames = NULL;
+    size_t releaseCount = 0, releaseCap = 0;
+    if (!done || !liveAfter || !releaseStart) { fprintf(stderr, "Memory allocation error in codegen\n"); exit(EXIT_FAILURE); }
+    LiveWord* live = newLiveSet(liveOut);
+    for (size_t i = count; i-- > 0;) {
+        releaseStart[i + 1] = releaseCount;
+        mentionStamp++;
+        collectReleases(stmts[i], 0, live, &releaseNames, &releaseCount, &releaseCap);
+        int block = stmts[i]->type == NODE_IF || stmts[i]->type == NODE_WHILE;
+        liveAfter[i] = block ? newLiveSet(live) : NULL;
+        liveBeforeStatement(stmts[i], live);
+    }
+    free(live);
+    if (count > 0) releaseStart[0] = releaseCount;
+
+    char indentStr[128];
+    makeIndent(indentStr, sizeof(indentStr), indentLevel);
+    for (size_t i = 0; i < count; ++i) {
+        const char* filename; int column;
+        int probe = currentOptions->profile && !done[i];
+        if (probe) { // The statement, or the batch it starts, and its releases
+            fprintf(outfile, "%s{ WzProbe _wz_probe; wz_probe_enter(&_wz_probe, %d);\n", indentStr, stmts[i]->lineno);
+        }
+        if (done[i]) {
+            // Moved up into an earlier batch; its releases stay here
+        } else if (!getLoadVectorArgs(stmts[i], &filename, &column)) {
+            generateStatementCode(stmts[i], outfile, indentLevel, liveAfter[i]);
+        } else {
+            Node* batch[LOAD_BATCH_WINDOW + 1];
+            int batchCount = 0;
+            batch[batchCount++] = stmts[i];
+            for (size_t k = i + 1; k < count && k <= i + LOAD_BATCH_WINDOW; ++k) {
+                const char* otherFile; int otherColumn;
+                if (done[k] || !getLoadVectorArgs(stmts[k], &otherFile, &otherColumn) || strcmp(otherFile, filename) != 0 ||
+                    isStreamedLoad(stmts[k]) != isStreamedLoad(stmts[i])) continue;
+                const char* target = stmts[k]->data.assignOp.name;
+                int safe = 1;
+                for (int b = 0; b < batchCount && safe; ++b) {
+                    if (strcmp(batch[b]->data.assignOp.name, target) == 0) safe = 0;
+                }
+                for (size_t m = i + 1; m < k && safe; ++m) {
+                    if (done[m]) continue; // Already moved up into this batch
+                    Node* saved = stmts[m]->next;
+                    stmts[m]->next = NULL; // Check this statement only
+                    if (mentionsName(stmts[m], target)) safe = 0;
+                    stmts[m]->next = saved;
+                }
+                if (!safe) continue;
+                batch[batchCount++] = stmts[k];
+                done[k] = 1;
+            }
+            if (batchCount == 1) {
+                generateStatementCode(stmts[i], outfile, indentLevel, liveAfter[i]);
+            } else {
+                fprintf(outfile, "%s", indentStr);
+                generateBatchedLoad(batch, batchCount, filename, outfile, indentStr);
+            }
+        }
+        // Names were collected from the last statement to the first
+        for (size_t r = releaseStart[i]; r > releaseStart[i + 1]; --r) {
+            fprintf(outfile, "%srelease_vector(&%s);\n", indentStr, releaseNames[r - 1]);
+        }
+        if (probe) fprintf(outfile, "%swz_probe_exit(&_wz_probe); }\n", indentStr);
+    }
+    for (size_t i = 0; i < count; ++i) free(liveAfter[i]);
+    free(liveAfter);
+    free(releaseStart);
+    free(releaseNames);
+    free(done);
+    free(stmts);
+}
+
+// Helper to generate C code for a single statement or expression.
+// liveAfter (needed for if/while only) holds the vectors live after the statement.
+static void generateStatementCode(Node* node, FILE* outfile, int indentLevel, const LiveWord* liveAfter) {
+    if (!node) return;
+    
+    // Indentation string, also used for continuation lines of multi-line constructs
+    char indentStr[128];
+    makeIndent(indentStr, sizeof(indentStr), indentLevel);
+    fprintf(outfile, "%s", indentStr);
 
     switch (node->type) {
         case NODE_ASSIGN:
@@ -29,42 +996,42 @@ static void generateStatementCode(Node* node, FILE* outfile, int indentLevel) {
                 strcmp(node->data.assignOp.value->data.funcCall.name, "load_vector") == 0) 
             {
                 // Generate code for: Vector var = load_vector(filename, col);
-                Node* funcNode = node->data.assignOp.value;
-                Node* filename_arg = funcNode->data.funcCall.args; 
-                Node* column_arg = filename_arg ? filename_arg->next : NULL;
-
-                if (filename_arg && filename_arg->type == NODE_ID /* Allow string literals later */ && 
-                    column_arg && column_arg->type == NODE_NUM && !column_arg->next) 
-                {   
-                    // **Update symbol table type!** (Crucial step missed earlier)
-                    // Ideally done in semantic analysis, but do it here for now.
-                    Symbol* sym = symtab_lookup(node->data.assignOp.name);
-                    if (sym) sym->type = TYPE_VECTOR;
-                     else { /* Error: Assigning to undeclared? Should be caught earlier */ }
-
-                    char* filename_str = filename_arg->data.id.sval; // Use ID name as filename
-                    int column_idx = (int)column_arg->data.dval;
-
-                    // 1. Get row count
-                    fprintf(outfile, "size_t %s_rows = count_file_rows(\"%s\");\n", node->data.assignOp.name, filename_str);
-                    // 2. Allocate vector (using generated helper)
-                    fprintf(outfile, "%s%s = create_vector(%s_rows);\n", indentStr, node->data.assignOp.name, node->data.assignOp.name);
-                    // 3. Read data (using generated helper)
-                    fprintf(outfile, "%sif (%s_rows > 0) {\n", indentStr, node->data.assignOp.name);
-                    fprintf(outfile, "%s    read_double_column(\"%s\", %d, %s.data, %s.size);\n", indentStr, filename_str, column_idx, node->data.assignOp.name, node->data.assignOp.name);
-                    fprintf(outfile, "%s}\n", indentStr);
-
+                const char* filename_str;
+                int column_idx;
+                if (getLoadVectorArgs(node, &filename_str, &column_idx)) {
+                    if (lhs_sym->streamed) { // Only reduced: fold the column into running statistics
+                        fprintf(outfile, "stream_column_stats(\"%s\", %d, &%s);\n", filename_str, column_idx, node->data.assignOp.name);
+                    } else { // Single pass over the file: rows are counted while parsing
+                        if (liveSlot(node->data.assignOp.name) >= 0) { // The load reads no variables: drop the old value first
+                            fprintf(outfile, "release_vector(&%s);\n%s", node->data.assignOp.name, indentStr);
+                        }
+                        fprintf(outfile, "%s = load_vector_column(\"%s\", %d);\n", node->data.assignOp.name, filename_str, column_idx);
+                    }
                 } else {
                     fprintf(outfile, "/* Codegen Error: Invalid arguments for load_vector assignment on line %d */\n", node->lineno);
                 }
 
+            } else if (node->data.assignOp.value && node->data.assignOp.value->type == NODE_FUNC_CALL &&
+                       strcmp(node->data.assignOp.value->data.funcCall.name, "create_vector") == 0) {
+                generateCreateAssign(node, outfile, indentStr);
+            } else if (node->data.assignOp.value && node->data.assignOp.value->type == NODE_VEC) { // Vector literal
+                generateLiteralAssign(node, outfile, indentStr);
+            } else if (isVectorExpr(node->data.assignOp.value)) { // Whole-vector arithmetic
+                generateVectorAssign(node, outfile, indentStr);
             } else { // Normal assignment
                 fprintf(outfile, "%s = ", node->data.assignOp.name);
                 generateExpressionCode(node->data.assignOp.value, outfile);
                 fprintf(outfile, ";\n");
             }
             break; // End of NODE_ASSIGN
-        case NODE_NUM: case NODE_ID: case NODE_BINOP: case NODE_UNARYOP: case NODE_VEC:
+        case NODE_INDEX_ASSIGN:
+            generateIndexAssign(node, outfile, indentStr);
+            break;
+        case NODE_NUM: case NODE_ID: case NODE_BINOP: case NODE_UNARYOP: case NODE_VEC: case NODE_INDEX:
+             if (isVectorExpr(node)) { // Result unused; nothing to compute
+                 fprintf(outfile, "/* Discarded vector expression on line %d */\n", node->lineno);
+                 break;
+             }
              generateExpressionCode(node, outfile);
              fprintf(outfile, ";\n");
              break;
@@ -72,38 +1039,35 @@ static void generateStatementCode(Node* node, FILE* outfile, int indentLevel) {
             fprintf(outfile, "if (");
             generateExpressionCode(node->data.ifStmt.condition, outfile);
             fprintf(outfile, ") {\n");
-            Node* thenStmt = node->data.ifStmt.then_branch;
-            while (thenStmt) {
-                generateStatementCode(thenStmt, outfile, indentLevel + 1);
-                thenStmt = thenStmt->next;
-            }
+            generateStatementList(node->data.ifStmt.then_branch, outfile, indentLevel + 1, liveAfter);
             for (int i = 0; i < indentLevel; ++i) fprintf(outfile, "    "); // Indent closing brace
             fprintf(outfile, "}");
             if (node->data.ifStmt.else_branch) {
                 fprintf(outfile, " else {\n");
-                Node* elseStmt = node->data.ifStmt.else_branch;
-                while (elseStmt) {
-                    generateStatementCode(elseStmt, outfile, indentLevel + 1);
-                    elseStmt = elseStmt->next;
-                }
+                generateStatementList(node->data.ifStmt.else_branch, outfile, indentLevel + 1, liveAfter);
                 for (int i = 0; i < indentLevel; ++i) fprintf(outfile, "    "); // Indent closing brace
                 fprintf(outfile, "}\n");
             } else {
                 fprintf(outfile, "\n");
             }
             break;
-        case NODE_WHILE:
+        case NODE_WHILE: {
+            int writableMark = writableCount;
+            hoistWritable(node->data.whileStmt.body, node->data.whileStmt.body, outfile, indentStr);
             fprintf(outfile, "while (");
             generateExpressionCode(node->data.whileStmt.condition, outfile);
             fprintf(outfile, ") {\n");
-            Node* bodyStmt = node->data.whileStmt.body;
-            while (bodyStmt) {
-                generateStatementCode(bodyStmt, outfile, indentLevel + 1);
-                bodyStmt = bodyStmt->next;
+            { // The body is followed by the loop head: the next iteration or the exit
+                LiveWord* head = newLiveSet(liveAfter);
+                liveBeforeLoop(node, head);
+                generateStatementList(node->data.whileStmt.body, outfile, indentLevel + 1, head);
+                free(head);
             }
             for (int i = 0; i < indentLevel; ++i) fprintf(outfile, "    "); // Indent closing brace
             fprintf(outfile, "}\n");
+            writableCount = writableMark;
             break;
+        }
         case NODE_FUNC_CALL:
             // Visualization and other built-ins
             if (strcmp(node->data.funcCall.name, "print_vector") == 0) {
@@ -114,35 +1078,28 @@ static void generateStatementCode(Node* node, FILE* outfile, int indentLevel) {
                 } else {
                     fprintf(outfile, "/* Codegen Error: Invalid arguments for print_vector */\n");
                 }
-            } else if (strcmp(node->data.funcCall.name, "average") == 0) {
+            } else if (findReductionBuiltin(node->data.funcCall.name)) {
+                // Reductions as statements print their result
+                const ReductionBuiltin* red = findReductionBuiltin(node->data.funcCall.name);
                 Node* vec_arg = node->data.funcCall.args;
                 if (vec_arg && vec_arg->type == NODE_ID && !vec_arg->next) {
-                     fprintf(outfile, "printf(\"Average of %s: %s\\n\", average_runtime(%s));\n", 
-                            vec_arg->data.id.sval, "%f", vec_arg->data.id.sval);
+                     fprintf(outfile, "print_reduction_runtime(\"%s\", \"%s\", ", red->label, vec_arg->data.id.sval);
+                     generateReductionCall(red, vec_arg->data.id.sval, outfile);
+                     fprintf(outfile, ");\n");
                 } else {
-                    fprintf(outfile, "/* Codegen Error: Invalid arguments for average */\n");
+                    fprintf(outfile, "/* Codegen Error: Invalid arguments for %s */\n", red->name);
                 }
-            } else if (strcmp(node->data.funcCall.name, "max_val") == 0) {
+             } else if (strcmp(node->data.funcCall.name, "length") == 0) { // Printed like a reduction
                  Node* vec_arg = node->data.funcCall.args;
-                 if (vec_arg && vec_arg->type == NODE_ID && !vec_arg->next) {
-                     fprintf(outfile, "printf(\"Max value of %s: %s\\n\", max_val_runtime(%s));\n", 
-                            vec_arg->data.id.sval, "%f", vec_arg->data.id.sval);
-                 } else {
-                     fprintf(outfile, "/* Codegen Error: Invalid arguments for max_val */\n");
-                 }
+                 fprintf(outfile, "print_reduction_runtime(\"Length\", \"%s\", (double)%s.size);\n", vec_arg->data.id.sval, vec_arg->data.id.sval);
              } else if (strcmp(node->data.funcCall.name, "plot_xy") == 0) {
                  Node* x_arg = node->data.funcCall.args;
                  Node* y_arg = x_arg ? x_arg->next : NULL;
                  if (x_arg && x_arg->type == NODE_ID && 
                      y_arg && y_arg->type == NODE_ID && !y_arg->next) {
-                     
-                     fprintf(outfile, "if (write_xy_to_file(%s, %s, \"gnuplot_data.tmp\")) {\n", x_arg->data.id.sval, y_arg->data.id.sval);
-                     fprintf(outfile, "%s    FILE *gnuplotPipe = open_gnuplot();\n", indentStr);
-                     fprintf(outfile, "%s    if (gnuplotPipe) {\n", indentStr);
-                     fprintf(outfile, "%s        fprintf(gnuplotPipe, \"plot 'gnuplot_data.tmp' using 1:2 with linespoints title '%s vs %s'\\n\");\n", indentStr, y_arg->data.id.sval, x_arg->data.id.sval );
-                     fprintf(outfile, "%s        pclose(gnuplotPipe);\n%s}\n%s}\n", indentStr, indentStr, indentStr); 
-                     fprintf(outfile, "%sremove(\"gnuplot_data.tmp\");\n", indentStr); // Clean up temp file
-
+                     // Points go down the gnuplot pipe in binary; no temp file
+                     fprintf(outfile, "plot_xy_runtime(%s, %s, \"%s vs %s\");\n", x_arg->data.id.sval, y_arg->data.id.sval,
+                             y_arg->data.id.sval, x_arg->data.id.sval);
                  } else {
                       fprintf(outfile, "/* Codegen Error: Invalid arguments for plot_xy (expecting two vector IDs) */\n");
                  }
@@ -187,7 +1144,7 @@ static void generateExpressionCode(Node* node, FILE* outfile) {
 
     switch (node->type) {
         case NODE_NUM:
-            fprintf(outfile, "%f", node->data.dval);
+            emitNumber(outfile, node->data.dval);
             break;
         case NODE_ID:
             // Semantic Check: Ensure variable exists (basic check)
@@ -201,17 +1158,11 @@ static void generateExpressionCode(Node* node, FILE* outfile) {
         case NODE_BINOP:
             // TODO: Add basic type checking here based on symbol table lookups of operands if they are IDs
             // e.g., if (getType(left) == TYPE_VECTOR || getType(right) == TYPE_VECTOR) { Error or Vector Op }
-            fprintf(outfile, "(");
+            fprintf(outfile, isComparison(node->data.binOp.op) ? "((double)(" : "(");
             generateExpressionCode(node->data.binOp.left, outfile);
-            switch (node->data.binOp.op) {
-                case OP_PLUS:  fprintf(outfile, " + "); break;
-                case OP_MINUS: fprintf(outfile, " - "); break;
-                case OP_STAR:  fprintf(outfile, " * "); break;
-                case OP_DIV:   fprintf(outfile, " / "); break;
-                default: fprintf(stderr, "Codegen Error: Unknown binary operator\n"); break;
-            }
+            fprintf(outfile, "%s", binaryOperator(node->data.binOp.op));
             generateExpressionCode(node->data.binOp.right, outfile);
-            fprintf(outfile, ")");
+            fprintf(outfile, isComparison(node->data.binOp.op) ? "))" : ")");
             break;
          case NODE_UNARYOP:
              fprintf(outfile, "(");
@@ -231,6 +1182,16 @@ static void generateExpressionCode(Node* node, FILE* outfile) {
             // For now, generate the call. This might not be valid C if void.
              if (strcmp(node->data.funcCall.name, "load_vector") == 0) {
                  fprintf(outfile, "/* load_vector used in expression - requires return value handling */");
+             } else if (findReductionBuiltin(node->data.funcCall.name)) {
+                 const ReductionBuiltin* red = findReductionBuiltin(node->data.funcCall.name);
+                 Node* vec_arg = node->data.funcCall.args;
+                 if (vec_arg && vec_arg->type == NODE_ID && !vec_arg->next) {
+                     generateReductionCall(red, vec_arg->data.id.sval, outfile);
+                 } else {
+                     fprintf(outfile, "/* Codegen Error: Invalid arguments for %s */ 0.0", red->name);
+                 }
+             } else if (strcmp(node->data.funcCall.name, "length") == 0) { // The semantic pass checked for a vector variable
+                 fprintf(outfile, "((double)%s.size)", node->data.funcCall.args->data.id.sval);
              } else {
                  fprintf(outfile, "%s(", node->data.funcCall.name);
                  Node* arg = node->data.funcCall.args;
@@ -244,133 +1205,78 @@ static void generateExpressionCode(Node* node, FILE* outfile) {
                  fprintf(outfile, ")");
              }
              break;
-        // Add cases for function calls, etc. later
-        
+        case NODE_INDEX:
+            generateElementAccess(node, outfile);
+            break;
+
         default:
             fprintf(stderr, "Codegen Error: Unsupported expression node type %d on line %d\n", node->type, node->lineno);
             break;
     }
 }
 
-// Helper for print_vector
-static void print_vector_runtime(Vector v, const char* name) {
-    printf("Vector %s (size %zu): [", name, v.size);
-    for (size_t i = 0; i < v.size; ++i) {
-        printf("%f%s", v.data[i], (i == v.size - 1) ? "" : ", ");
-    }
-    printf("]\n");
-}
-
-// Helper for average
-static double average_runtime(Vector v) {
-    if (v.size == 0) return 0.0; // Or NaN?
-    double sum = 0.0;
-    for (size_t i = 0; i < v.size; ++i) {
-        sum += v.data[i];
-    }
-    return sum / v.size;
+void initCodegenOptions(CodegenOptions* options) {
+    options->enableCache = 0;
+    options->compensatedSum = 0;
+    options->parallel = 0;
+    options->streamReductions = 1;
+    options->plotPoints = 4000;
+    options->plotDecimate = 0;
+    options->inlineRuntime = 0;
+    options->profile = 0;
+    options->sourceName = "stdin";
 }
 
-// Helper for max_val
-static double max_val_runtime(Vector v) {
-    if (v.size == 0) return -INFINITY; // Or handle error
-    double max = v.data[0];
-    for (size_t i = 1; i < v.size; ++i) {
-        if (v.data[i] > max) max = v.data[i];
+// Highest line number of any statement, for the profile's line table
+static int maxStatementLine(Node* first) {
+    int max = 0;
+    for (Node* s = first; s; s = s->next) {
+        if (s->lineno > max) max = s->lineno;
+        int inner = 0;
+        if (s->type == NODE_IF) {
+            inner = maxStatementLine(s->data.ifStmt.then_branch);
+            int other = maxStatementLine(s->data.ifStmt.else_branch);
+            if (other > inner) inner = other;
+        } else if (s->type == NODE_WHILE) {
+            inner = maxStatementLine(s->data.whileStmt.body);
+        }
+        if (inner > max) max = inner;
     }
     return max;
 }
 
-// Helper to open gnuplot pipe
-static FILE* open_gnuplot() {
-    FILE* gp = popen("gnuplot -persist", "w");
-    if (!gp) {
-        fprintf(stderr, "Error opening gnuplot pipe.\n");
-    }
-    return gp;
-}
-
-// Helper to write vector data to temp file for gnuplot
-// Returns 1 on success, 0 on failure
-static int write_vector_to_file(Vector v, const char* filename) {
-    FILE* f = fopen(filename, "w");
-    if (!f) return 0;
-    for(size_t i = 0; i < v.size; ++i) {
-        fprintf(f, "%f\n", v.data[i]);
-    }
-    fclose(f);
-    return 1;
-}
-// Helper to write two vectors (X, Y) to temp file
-static int write_xy_to_file(Vector x, Vector y, const char* filename) {
-     if (x.size != y.size) {
-        fprintf(stderr, "Error: X and Y vectors must have same size for plot_xy.\n");
-        return 0;
-     }
-     FILE* f = fopen(filename, "w");
-     if (!f) return 0;
-     for(size_t i = 0; i < x.size; ++i) {
-         fprintf(f, "%f %f\n", x.data[i], y.data[i]);
-     }
-     fclose(f); 
-     return 1;
-}
-
 // Main code generation function
-void generateCode(Node* astRoot, FILE* outfile) {
+void generateCode(Node* astRoot, FILE* outfile, const CodegenOptions* options) {
     if (!outfile) {
         fprintf(stderr, "Codegen Error: Output file is NULL\n");
         return;
     }
+    CodegenOptions defaults;
+    if (!options) {
+        initCodegenOptions(&defaults);
+        options = &defaults;
+    }
+    currentOptions = options;
 
-    // 1. Boilerplate Start
-    fprintf(outfile, "#include <stdio.h>\n");
-    fprintf(outfile, "#include <stdlib.h> // For malloc, free, exit, atof\n");
-    fprintf(outfile, "#include <string.h> // For strtok_r, strcmp\n");
-    fprintf(outfile, "#include <math.h> \n\n");
-
-    // Define Vector struct in generated code
-    fprintf(outfile, "// --- WizuAll Data Structures ---\n");
-    fprintf(outfile, "typedef struct {\n");
-    fprintf(outfile, "    double* data;\n");
-    fprintf(outfile, "    size_t size;\n");
-    fprintf(outfile, "} Vector;\n\n");
-
-    // Define helper functions in generated code
-    fprintf(outfile, "// --- WizuAll Runtime Helpers ---\n");
-    // Count rows helper
-    fprintf(outfile, "static size_t count_file_rows(const char* filename) {\n");
-    fprintf(outfile, "    FILE* f = fopen(filename, \"r\");\n");
-    fprintf(outfile, "    if (!f) { fprintf(stderr, \"Error opening file: %s\\n\", filename); return 0; }\n");
-    fprintf(outfile, "    size_t count = 0; int ch;\n");
-    fprintf(outfile, "    while (EOF != (ch = fgetc(f))) { if (ch == '\\n') count++; }\n");
-    // TODO: Handle files not ending in newline? 
-    fprintf(outfile, "    fclose(f); return count; \n}\n\n");
-    // Read column helper
-    fprintf(outfile, "static int read_double_column(const char* filename, int column, double* data, size_t max_rows) {\n");
-    fprintf(outfile, "    FILE* f = fopen(filename, \"r\");\n");
-    fprintf(outfile, "    if (!f) return 0;\n");
-    fprintf(outfile, "    char line[2048]; size_t row = 0;\n"); // Increased buffer size
-    fprintf(outfile, "    while (row < max_rows && fgets(line, sizeof(line), f)) {\n");
-    fprintf(outfile, "        char* token; char* rest = line; int current_col = 0; int found = 0;\n");
-    fprintf(outfile, "        while ((token = strtok_r(rest, \" \\t,\\n\", &rest))) {\n");
-    fprintf(outfile, "            if (current_col == column) { data[row] = atof(token); found = 1; break; }\n");
-    fprintf(outfile, "            current_col++;\n        }\n");
-    // Add basic error if column not found? fprintf(outfile, " if (!found) { data[row]=0.0; /* Or handle error */ }\n");
-    fprintf(outfile, "        row++;\n    }\n");
-    fprintf(outfile, "    fclose(f); return 1;\n}\n\n");
-    // Vector creation helper
-    fprintf(outfile, "static Vector create_vector(size_t size) {\n");
-    fprintf(outfile, "    Vector v; v.size = size; v.data = (double*)malloc(size * sizeof(double));\n");
-    fprintf(outfile, "    if (!v.data && size > 0) { fprintf(stderr, \"Vector allocation failed\\n\"); exit(1); }\n");
-    fprintf(outfile, "    for(size_t i=0; i<size; ++i) v.data[i] = 0.0; /* Initialize */ \n");
-    fprintf(outfile, "    return v;\n}\n\n");
-    // Vector free helper
-     fprintf(outfile, "static void free_vector(Vector v) {\n");
-     fprintf(outfile, "    free(v.data);\n}\n\n");
+    // 1. Boilerplate Start: the runtime library header (or its inlined source)
+    emitRuntime(outfile, options);
+
+    // Variable types come from the semantic pass (analyzeSemantics)
+    if (options->streamReductions) {
+        markStreamedSymbols(astRoot);
+    }
 
     fprintf(outfile, "// --- Main Program ---\n");
     fprintf(outfile, "int main() {\n");
+    emitRuntimeConfig(outfile, options);
+    if (options->profile) {
+        fprintf(outfile, "    wz_profile_start(\"");
+        for (const char* c = options->sourceName; *c; ++c) { // C string literal
+            if (*c == '"' || *c == '\\') fputc('\\', outfile);
+            if ((unsigned char)*c >= ' ') fputc(*c, outfile);
+        }
+        fprintf(outfile, "\", %d);\n\n", maxStatementLine(astRoot));
+    }
 
     // 2. Variable Declarations
     fprintf(outfile, "    // Variable Declarations\n");
@@ -378,8 +1284,16 @@ void generateCode(Node* astRoot, FILE* outfile) {
         Symbol* current = globalSymTab->head;
         while (current != NULL) {
             // Check type BEFORE generating declaration
-            if (current->type == TYPE_VECTOR) {
-                 fprintf(outfile, "    Vector %s; %s.data=NULL; %s.size=0; /* Initialized empty */\n", current->name, current->name, current->name);
+            if (current->streamed) {
+                 fprintf(outfile, "    static StreamStats %s; stream_stats_reset(&%s); /* Streamed: only reduced */\n", current->name, current->name);
+            }
+            else if (current->type == TYPE_VECTOR && stackVectorLength(current->name) > 0) {
+                 fprintf(outfile, "    double _wz_buf_%s[%ld]; Vector %s; %s.data=_wz_buf_%s; %s.size=0; %s.owned=0; /* Stack buffer: always %ld elements */\n",
+                         current->name, current->fixed_length, current->name, current->name, current->name, current->name, current->name,
+                         current->fixed_length);
+            }
+            else if (current->type == TYPE_VECTOR) {
+                 fprintf(outfile, "    Vector %s; %s.data=NULL; %s.size=0; %s.owned=0; /* Initialized empty */\n", current->name, current->name, current->name, current->name);
             }
             else { // Treat UNDEFINED and SCALAR as double for now
                 fprintf(outfile, "    double %s = 0.0; \n", current->name);
@@ -390,15 +1304,14 @@ void generateCode(Node* astRoot, FILE* outfile) {
     fprintf(outfile, "\n    // Code Body\n");
 
     // 3. Generate Code for Statements
-    Node* currentStatement = astRoot;
-    while (currentStatement != NULL) {
-        generateStatementCode(currentStatement, outfile, 1); // Indent level 1 within main
-        currentStatement = currentStatement->next;
-    }
+    assignLiveSlots();
+    LiveWord* liveAtExit = newLiveSet(NULL); // Nothing is live after the program
+    generateStatementList(astRoot, outfile, 1, liveAtExit); // Indent level 1 within main
+    free(liveAtExit);
+    free(slotStamp);
+    slotStamp = NULL;
 
     // 4. Boilerplate End
     fprintf(outfile, "\n    return 0;\n");
     fprintf(outfile, "}\n");
-
-    printf("C code generated successfully.\n");
 } 
\ No newline at end of file
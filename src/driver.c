@@ -0,0 +1,362 @@
+#include "driver.h"
+#include <stdio.h>
+#include <stdlib.h>   // For getenv, malloc, free
+#include <string.h>   // For strcmp, strlen, strtok
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>    // For open
+#include <unistd.h>   // For access, fork, execv, getpid, unlink
+#include <sys/stat.h> // For stat, mkdir
+#include <sys/wait.h> // For waitpid
+#include "sha256.h"
+#include "stats.h"    // Phase timing (--stats)
+
+// Where the Makefile put the runtime header and libraries (overridden with -D
+// at build time); without them, programs are built with the inline runtime
+#ifndef WIZURT_INCLUDE_DIR
+#define WIZURT_INCLUDE_DIR "runtime"
+#endif
+#ifndef WIZURT_LIB_DIR
+#define WIZURT_LIB_DIR "build"
+#endif
+
+#define NATIVE_CACHE_FORMAT "wizuall-native-1" // Change to invalidate every cached executable
+#define NATIVE_MAX_ARGS 256
+
+typedef struct {
+    const char* name;
+    const char* flags;
+    int lto; // Compile with -flto and link libwizurt-lto, so runtime helpers inline into the program
+} OptProfile;
+
+static const OptProfile profiles[] = {
+    { "debug",   "-O0 -g",            0 },
+    { "release", "-O2",               0 },
+    { "fast",    "-O3",               1 },
+    { "native",  "-O3 -march=native", 1 },
+};
+
+static const OptProfile* findProfile(const char* name) {
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+        if (strcmp(profiles[i].name, name) == 0) return &profiles[i];
+    }
+    return NULL;
+}
+
+static const char* compilerCommand(void) {
+    const char* cc = getenv("CC");
+    return cc && *cc ? cc : "cc";
+}
+
+static const char* runtimeLibrary(const OptProfile* profile) {
+    return profile->lto ? WIZURT_LIB_DIR "/libwizurt-lto.a" : WIZURT_LIB_DIR "/libwizurt.a";
+}
+
+void initNativeOptions(NativeOptions* native) {
+    native->exec = 0;
+    native->profile = "release";
+    native->extraFlags = "";
+    native->optimize = 1;
+}
+
+// --- Cache key ---
+
+// Hashes a length-prefixed field, so adjacent fields cannot run together
+static void hashField(Sha256* h, const void* data, size_t size) {
+    uint64_t length = size;
+    sha256_update(h, &length, sizeof(length));
+    sha256_update(h, data, size);
+}
+
+static void hashString(Sha256* h, const char* s) {
+    hashField(h, s, strlen(s));
+}
+
+// Hashes a file's contents (as the hex digest of its own hash)
+static int hashFile(Sha256* h, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    Sha256 content;
+    sha256_init(&content);
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        sha256_update(&content, buffer, n);
+    }
+    int failed = ferror(f);
+    fclose(f);
+    if (failed) return -1;
+    char hex[65];
+    sha256_hex(&content, hex);
+    hashString(h, hex);
+    return 0;
+}
+
+// Hashes the output of `$CC --version`: a compiler upgrade rebuilds everything
+static int hashCompilerVersion(Sha256* h, const char* cc) {
+    char command[PATH_MAX + 32];
+    snprintf(command, sizeof(command), "%s --version 2>/dev/null", cc);
+    FILE* pipe = popen(command, "r");
+    if (!pipe) return -1;
+    char buffer[4096];
+    size_t n, total = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        hashField(h, buffer, n);
+        total += n;
+    }
+    int status = pclose(pipe);
+    return status == 0 && total > 0 ? 0 : -1;
+}
+
+// Hashes the identity of this wizuallc build (code generation may change with
+// it). Size and modification time, like ccache's compiler check, rather than
+// the contents: this runs on every cached launch.
+static void hashCompilerBuild(Sha256* h) {
+    struct stat st;
+    char identity[128];
+    if (stat("/proc/self/exe", &st) == 0) {
+        snprintf(identity, sizeof(identity), "%lld %lld %lld", (long long)st.st_size,
+                 (long long)st.st_mtime, (long long)st.st_ino);
+    } else {
+        snprintf(identity, sizeof(identity), "%s %s", __DATE__, __TIME__);
+    }
+    hashString(h, identity);
+}
+
+// --- Cache directory ---
+
+// Creates path and its missing parents (mkdir -p)
+static int makeDirectories(char* path) {
+    for (char* p = path + 1; ; p++) {
+        if (*p == '/' || *p == '\0') {
+            char saved = *p;
+            *p = '\0';
+            int failed = mkdir(path, 0755) != 0 && errno != EEXIST;
+            *p = saved;
+            if (failed) return -1;
+            if (saved == '\0') return 0;
+        }
+    }
+}
+
+static int cacheDirectory(char* dir, size_t size) {
+    const char* env = getenv("WIZUALL_CACHE_DIR");
+    int n;
+    if (env && *env) {
+        n = snprintf(dir, size, "%s", env);
+    } else if ((env = getenv("XDG_CACHE_HOME")) && *env) {
+        n = snprintf(dir, size, "%s/wizuall", env);
+    } else if ((env = getenv("HOME")) && *env) {
+        n = snprintf(dir, size, "%s/.cache/wizuall", env);
+    } else {
+        fprintf(stderr, "Native build error: no cache directory (set WIZUALL_CACHE_DIR or HOME)\n");
+        return -1;
+    }
+    if (n < 0 || (size_t)n >= size) {
+        fprintf(stderr, "Native build error: cache directory path too long\n");
+        return -1;
+    }
+    if (makeDirectories(dir) != 0) {
+        fprintf(stderr, "Native build error: cannot create %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int nativePrepare(const char* sourcePath, CodegenOptions* options, const NativeOptions* native, NativeBuild* build) {
+    const OptProfile* profile = findProfile(native->profile);
+    if (!profile) {
+        fprintf(stderr, "Unknown optimization profile: %s (expected debug, release, fast or native)\n", native->profile);
+        return 1;
+    }
+    if (!options->inlineRuntime &&
+        (access(WIZURT_INCLUDE_DIR "/wizurt.h", R_OK) != 0 || access(runtimeLibrary(profile), R_OK) != 0)) {
+        options->inlineRuntime = 1; // libwizurt not built: compile the runtime into the program
+    }
+
+    Sha256 h;
+    sha256_init(&h);
+    hashString(&h, NATIVE_CACHE_FORMAT);
+    hashCompilerBuild(&h);
+    if (hashFile(&h, sourcePath) != 0) {
+        perror(sourcePath);
+        return 1;
+    }
+    char settings[256];
+    snprintf(settings, sizeof(settings), "cache=%d kahan=%d parallel=%d stream=%d plot=%d/%d inline=%d optimize=%d profile=%d",
+             options->enableCache, options->compensatedSum, options->parallel, options->streamReductions,
+             options->plotPoints, options->plotDecimate, options->inlineRuntime, native->optimize, options->profile);
+    hashString(&h, settings);
+    hashString(&h, options->profile ? options->sourceName : ""); // Named in the profile report
+    const char* cc = compilerCommand();
+    hashString(&h, cc);
+    hashString(&h, profile->flags);
+    hashString(&h, profile->lto ? "lto" : "");
+    hashString(&h, native->extraFlags);
+    if (hashCompilerVersion(&h, cc) != 0) {
+        fprintf(stderr, "Native build error: cannot run C compiler '%s' (set CC)\n", cc);
+        return 1;
+    }
+    if (!options->inlineRuntime &&
+        (hashFile(&h, WIZURT_INCLUDE_DIR "/wizurt.h") != 0 || hashFile(&h, runtimeLibrary(profile)) != 0)) {
+        fprintf(stderr, "Native build error: cannot read libwizurt in %s\n", WIZURT_LIB_DIR);
+        return 1;
+    }
+    sha256_hex(&h, build->key);
+
+    char dir[PATH_MAX - 96]; // Leaves room for "/<key>" in exePath
+    if (cacheDirectory(dir, sizeof(dir)) != 0) return 1;
+    snprintf(build->exePath, sizeof(build->exePath), "%s/%s", dir, build->key);
+    build->cached = access(build->exePath, X_OK) == 0;
+    build->generatedBytes = 0;
+    return 0;
+}
+
+// --- Compilation ---
+
+// Appends the space-separated words of s to args (s is copied into storage)
+static int appendWords(char** args, int* count, const char* s, char** storage) {
+    char* copy = (char*)malloc(strlen(s) + 1);
+    if (!copy) return -1;
+    strcpy(copy, s);
+    *storage = copy;
+    for (char* word = strtok(copy, " \t"); word; word = strtok(NULL, " \t")) {
+        if (*count >= NATIVE_MAX_ARGS - 1) return -1;
+        args[(*count)++] = word;
+    }
+    return 0;
+}
+
+// Runs the compiler and waits for it; returns its exit status
+static int runCompiler(char** args) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        execvp(args[0], args);
+        perror(args[0]);
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int nativeCompile(Node* astRoot, const CodegenOptions* options, const NativeOptions* native, NativeBuild* build) {
+    const OptProfile* profile = findProfile(native->profile);
+    // Unique temporaries, renamed into place once complete: concurrent builds
+    // of the same program never see a partial executable
+    char cPath[PATH_MAX + 32], tmpPath[PATH_MAX + 32];
+    snprintf(cPath, sizeof(cPath), "%s.%ld.c", build->exePath, (long)getpid());
+    snprintf(tmpPath, sizeof(tmpPath), "%s.%ld.tmp", build->exePath, (long)getpid());
+
+    FILE* outfile = fopen(cPath, "w");
+    if (!outfile) {
+        perror(cPath);
+        return 1;
+    }
+    stats_phase_begin("codegen");
+    generateCode(astRoot, outfile, options);
+    long written = ftell(outfile);
+    if (fclose(outfile) != 0) {
+        perror(cPath);
+        unlink(cPath);
+        return 1;
+    }
+    stats_phase_end();
+    build->generatedBytes = written > 0 ? (size_t)written : 0;
+
+    char* args[NATIVE_MAX_ARGS];
+    char* storage[3] = { NULL, NULL, NULL };
+    char includeFlag[PATH_MAX];
+    int count = 0, failed = 0;
+    failed |= appendWords(args, &count, compilerCommand(), &storage[0]);
+    failed |= appendWords(args, &count, profile->flags, &storage[1]);
+    failed |= appendWords(args, &count, native->extraFlags, &storage[2]);
+    if (failed || count + 12 > NATIVE_MAX_ARGS) {
+        fprintf(stderr, "Native build error: too many compiler flags\n");
+        failed = 1;
+    } else {
+        if (profile->lto) args[count++] = "-flto";
+        if (!options->inlineRuntime) {
+            snprintf(includeFlag, sizeof(includeFlag), "-I%s", WIZURT_INCLUDE_DIR);
+            args[count++] = includeFlag;
+        }
+        args[count++] = "-o";
+        args[count++] = tmpPath;
+        args[count++] = cPath;
+        if (!options->inlineRuntime) {
+            args[count++] = "-L" WIZURT_LIB_DIR;
+            args[count++] = profile->lto ? "-lwizurt-lto" : "-lwizurt";
+        }
+        args[count++] = "-lm";
+        args[count++] = "-pthread";
+        args[count++] = "-fopenmp"; // libwizurt is built with OpenMP; --parallel programs need it too
+        args[count] = NULL;
+        stats_phase_begin("cc");
+        int status = runCompiler(args);
+        stats_phase_end();
+        if (status != 0) {
+            fprintf(stderr, "Native build error: C compiler failed (status %d)\n", status);
+            failed = 1;
+        } else if (rename(tmpPath, build->exePath) != 0) {
+            perror(build->exePath);
+            failed = 1;
+        }
+    }
+    for (int i = 0; i < 3; i++) free(storage[i]);
+    unlink(cPath);
+    if (failed) {
+        unlink(tmpPath);
+        return 1;
+    }
+    build->cached = 1;
+    return 0;
+}
+
+// Copies the cached executable to path (a copy, so evicting the cache never breaks it)
+static int copyExecutable(const char* from, const char* path) {
+    int in = open(from, O_RDONLY);
+    if (in < 0) {
+        perror(from);
+        return 1;
+    }
+    unlink(path); // Replaces a running executable without "text file busy"
+    int out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    if (out < 0) {
+        perror(path);
+        close(in);
+        return 1;
+    }
+    char buffer[65536];
+    ssize_t n;
+    int failed = 0;
+    while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, (size_t)n) != n) {
+            failed = 1;
+            break;
+        }
+    }
+    if (n < 0) failed = 1;
+    close(in);
+    if (close(out) != 0) failed = 1;
+    if (failed) {
+        perror(path);
+        unlink(path);
+        return 1;
+    }
+    return 0;
+}
+
+int nativeFinish(const NativeBuild* build, const NativeOptions* native, const char* outputPath) {
+    if (!native->exec) {
+        return copyExecutable(build->exePath, outputPath);
+    }
+    fflush(stdout);
+    char* args[] = { (char*)build->exePath, NULL };
+    execv(build->exePath, args); // The program's exit status becomes ours
+    perror(build->exePath);
+    return 1;
+}
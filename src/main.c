@@ -1,7 +1,16 @@
 #include <stdio.h>
+#include <stdlib.h>  // For strtol
+#include <string.h>  // For strcmp
+#include <unistd.h>  // For isatty
 #include "ast.h"     // Include AST definitions
 #include "symtab.h"  // Include Symbol Table definitions
 #include "codegen.h" // Include Code Generator definitions
+#include "optimize.h" // AST optimization pass
+#include "semantic.h" // Type and shape inference
+#include "arena.h"   // Compilation arena (AST, symbols, names)
+#include "vm.h"      // In-process execution (--run)
+#include "driver.h"  // Native build with executable cache (--build, --exec)
+#include "stats.h"   // Phase timing and memory report (--stats)
 
 // --- External Declarations ---
 // Function generated by Bison from parser.y
@@ -12,79 +21,306 @@ extern FILE *yyin;
 extern Node *astRoot;
 // Line number tracker from lexer.l (optional, useful for errors)
 extern int yylineno;
+// Lexer entry point, restart on a new input, and error message switch (lexer.l)
+extern int yylex(void);
+extern void yyrestart(FILE *input_file);
+extern int lex_quiet;
 // symtab_init/destroy defined in symtab.c
 
+static void printUsage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options] [input_program.wzu] [output_c_file.c]\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --cache            Cache parsed load_vector inputs in binary sidecar files (<file>.wzcache)\n");
+    fprintf(stderr, "  --no-cache         Always parse load_vector inputs as text (default)\n");
+    fprintf(stderr, "  --compensated-sum  Use Kahan-compensated summation in sum/mean/variance/stddev\n");
+    fprintf(stderr, "  --parallel         Run large vector operations and reductions on all cores (compile with -fopenmp)\n");
+    fprintf(stderr, "  --no-streaming     Load every vector into memory, even if it is only used by reductions\n");
+    fprintf(stderr, "  --plot-points=N    Decimate plot_xy series longer than N points (default 4000, 0 = never)\n");
+    fprintf(stderr, "  --plot-decimate=M  Decimation method: minmax (default, keeps every spike) or lttb\n");
+    fprintf(stderr, "  --profile          Report time, executions, bytes allocated and bytes read per source line at exit\n");
+    fprintf(stderr, "  --run              Execute the program directly (bytecode VM) instead of writing C\n");
+    fprintf(stderr, "  --inline-runtime   Embed the runtime in the output instead of linking libwizurt\n");
+    fprintf(stderr, "  --build            Compile to a native executable (output file defaults to the input name without .wzu)\n");
+    fprintf(stderr, "  --exec             Compile to a native executable and run it\n");
+    fprintf(stderr, "                     Executables are cached by source, options, compiler and flags ($WIZUALL_CACHE_DIR)\n");
+    fprintf(stderr, "  --opt=PROFILE      Native build profile: debug, release (default, -O2), fast (-O3, LTO)\n");
+    fprintf(stderr, "                     or native (-O3 -march=native, LTO); the C compiler is $CC\n");
+    fprintf(stderr, "  --cflags=FLAGS     Extra C compiler flags for --build/--exec\n");
+    fprintf(stderr, "  --stats            Report time and memory per compiler phase, and program sizes, on stderr\n");
+    fprintf(stderr, "  --verbose          Trace the symbol table and dump the AST while compiling\n");
+    fprintf(stderr, "  --no-optimize      Skip constant folding/propagation and algebraic simplification\n");
+    fprintf(stderr, "  --help             Show this message\n");
+}
+
+// Reads all of input into a malloc'd buffer
+static char* readAll(FILE* input, size_t* size) {
+    size_t cap = 1 << 16, len = 0;
+    char* buf = (char*)malloc(cap);
+    size_t n;
+    while (buf && (n = fread(buf + len, 1, cap - len, input)) > 0) {
+        len += n;
+        if (len == cap) buf = (char*)realloc(buf, cap *= 2);
+    }
+    if (!buf) {
+        fprintf(stderr, "Memory allocation error reading input\n");
+        exit(EXIT_FAILURE);
+    }
+    *size = len;
+    return buf;
+}
+
+// Releases the compilation state, printing the --stats report first
+static void endCompilation(int stats, CompileCounts* counts) {
+    counts->nodes = ast_node_count;
+    counts->symbols = globalSymTab ? (size_t)globalSymTab->count : 0;
+    if (stats) stats_report(stderr, counts);
+    symtab_destroy();
+    arena_destroy(&compileArena); // Frees the AST, symbols and names at once
+}
+
 int main(int argc, char **argv) {
     FILE *inputFile = stdin;
     const char* out_filename = "output.c"; // Default output filename
     const char* in_filename = "stdin";
+    CodegenOptions options;
+    initCodegenOptions(&options);
+    int optimize = 1; // Run the AST optimization pass (--no-optimize disables it)
+    int run = 0;      // Execute in process instead of generating C (--run)
+    int native = 0;   // Build a native executable (--build, --exec)
+    int verbose = 0;  // Symbol table trace, AST dump and progress messages on stdout (--verbose)
+    int stats = 0;    // Phase timing and memory report on stderr (--stats)
+    CompileCounts counts = {0};
+    NativeOptions nativeOptions;
+    initNativeOptions(&nativeOptions);
 
-    // Basic argument handling
-    if (argc > 1) {
-        in_filename = argv[1];
+    // Argument handling: options anywhere, then optional input and output files
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cache") == 0) {
+            options.enableCache = 1;
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            options.enableCache = 0;
+        } else if (strcmp(argv[i], "--compensated-sum") == 0) {
+            options.compensatedSum = 1;
+        } else if (strcmp(argv[i], "--parallel") == 0) {
+            options.parallel = 1;
+        } else if (strcmp(argv[i], "--no-streaming") == 0) {
+            options.streamReductions = 0;
+        } else if (strncmp(argv[i], "--plot-points=", 14) == 0) {
+            char* end;
+            long points = strtol(argv[i] + 14, &end, 10);
+            if (end == argv[i] + 14 || *end || points < 0 || points > 100000000) {
+                fprintf(stderr, "Invalid point count: %s\n", argv[i]);
+                return 1;
+            }
+            options.plotPoints = (int)points;
+        } else if (strcmp(argv[i], "--plot-decimate=minmax") == 0) {
+            options.plotDecimate = 0;
+        } else if (strcmp(argv[i], "--plot-decimate=lttb") == 0) {
+            options.plotDecimate = 1;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            options.profile = 1;
+        } else if (strcmp(argv[i], "--run") == 0) {
+            run = 1;
+        } else if (strcmp(argv[i], "--inline-runtime") == 0) {
+            options.inlineRuntime = 1;
+        } else if (strcmp(argv[i], "--build") == 0) {
+            native = 1;
+        } else if (strcmp(argv[i], "--exec") == 0) {
+            native = 1;
+            nativeOptions.exec = 1;
+        } else if (strncmp(argv[i], "--opt=", 6) == 0) {
+            nativeOptions.profile = argv[i] + 6;
+        } else if (strncmp(argv[i], "--cflags=", 9) == 0) {
+            nativeOptions.extraFlags = argv[i] + 9;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "--no-optimize") == 0) {
+            optimize = 0;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        } else if (positional == 0) {
+            in_filename = argv[i];
+            positional++;
+        } else if (positional == 1) { // Optional output file argument
+            out_filename = argv[i];
+            positional++;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    options.sourceName = in_filename;
+    if (run && options.profile) {
+        fprintf(stderr, "--profile instruments generated programs and cannot be combined with --run\n");
+        return 1;
+    }
+
+    NativeBuild build;
+    char exe_filename[PATH_MAX];
+    if (native) {
+        if (run || positional == 0) {
+            fprintf(stderr, "--build and --exec need an input file and cannot be combined with --run\n");
+            return 1;
+        }
+        if (positional < 2) { // Executable named after the program: prog.wzu -> prog
+            size_t len = strlen(in_filename);
+            if (len > 4 && strcmp(in_filename + len - 4, ".wzu") == 0 && len - 4 < sizeof(exe_filename)) {
+                snprintf(exe_filename, sizeof(exe_filename), "%.*s", (int)(len - 4), in_filename);
+            } else {
+                snprintf(exe_filename, sizeof(exe_filename), "a.out");
+            }
+            out_filename = exe_filename;
+        }
+        nativeOptions.optimize = optimize;
+        stats_phase_begin("cache");
+        if (nativePrepare(in_filename, &options, &nativeOptions, &build) != 0) return 1;
+        stats_phase_end();
+        if (build.cached) { // Unchanged program: no parsing, codegen or C compile
+            if (stats) stats_report(stderr, NULL);
+            return nativeFinish(&build, &nativeOptions, out_filename);
+        }
+    }
+
+    if (positional > 0) {
         inputFile = fopen(in_filename, "r");
         if (!inputFile) {
             perror(in_filename);
             return 1;
         }
         yyin = inputFile; 
-        if (argc > 2) { // Optional output file argument
-            out_filename = argv[2];
-        }
-    } else {
-        printf("Reading from standard input. Press Ctrl+D (Unix/Mac) or Ctrl+Z (Windows) to end.\n");
+    } else if (verbose || isatty(STDIN_FILENO)) {
+        fprintf(stderr, "Reading from standard input. Press Ctrl+D (Unix/Mac) or Ctrl+Z (Windows) to end.\n");
     }
 
+    symtab_trace = verbose;
     symtab_init(); // Initialize the symbol table
 
-    printf("Parsing input from %s...\n", in_filename);
+    // With --stats the lexer first runs alone over the source to time it and
+    // count tokens; the parser then lexes the same text again
+    char* source = NULL;
+    double lexSeconds = 0;
+    if (stats) {
+        source = readAll(inputFile, &counts.sourceBytes);
+        for (size_t i = 0; i < counts.sourceBytes; i++) counts.sourceLines += source[i] == '\n';
+        if (counts.sourceBytes > 0 && source[counts.sourceBytes - 1] != '\n') counts.sourceLines++;
+        if (counts.sourceBytes > 0) {
+            FILE* text = fmemopen(source, counts.sourceBytes, "r");
+            if (!text) {
+                perror("fmemopen");
+                return 1;
+            }
+            stats_phase_begin("lex");
+            yyrestart(text);
+            lex_quiet = 1; // Errors are reported by the parsing pass
+            while (yylex() != 0) counts.tokens++;
+            lex_quiet = 0;
+            lexSeconds = stats_phase_end()->seconds;
+            fclose(text);
+            text = fmemopen(source, counts.sourceBytes, "r");
+            if (!text) {
+                perror("fmemopen");
+                return 1;
+            }
+            yylineno = 1;
+            yyrestart(text);
+            if (inputFile != stdin) fclose(inputFile);
+            inputFile = text;
+        }
+    }
+
+    if (verbose) printf("Parsing input from %s...\n", in_filename);
+    stats_phase_begin("parse");
     int parse_result = yyparse(); // Start the parsing process
+    PhaseStats* parsePhase = stats_phase_end();
+    parsePhase->seconds = parsePhase->seconds > lexSeconds ? parsePhase->seconds - lexSeconds : 0; // Lexing is its own row
 
     if (inputFile != stdin) {
         fclose(inputFile);
     }
+    free(source);
 
     if (parse_result == 0) { // 0 indicates successful parsing
-        printf("Parsing successful!\n");
-        symtab_print(); // Print symbol table content
+        if (verbose) printf("Parsing successful!\n");
+        if (optimize) {
+            stats_phase_begin("optimize");
+            optimizeAST(astRoot); // Fold constants and simplify before printing and code generation
+            stats_phase_end();
+        }
+        stats_phase_begin("semantic");
+        int semantic_errors = analyzeSemantics(astRoot); // Types and vector lengths for codegen
+        stats_phase_end();
+        if (semantic_errors > 0) {
+            printf("Semantic analysis failed (%d error%s).\n", semantic_errors, semantic_errors == 1 ? "" : "s");
+            endCompilation(stats, &counts);
+            return 1;
+        }
+        if (native) { // Generate C into the cache and compile it
+            int status = nativeCompile(astRoot, &options, &nativeOptions, &build);
+            counts.outputBytes = build.generatedBytes;
+            endCompilation(stats, &counts);
+            return status != 0 ? status : nativeFinish(&build, &nativeOptions, out_filename);
+        }
+        if (run) { // Lower to bytecode and execute; nothing is written
+            stats_phase_begin("run");
+            int status = runProgram(astRoot, &options);
+            stats_phase_end();
+            endCompilation(stats, &counts);
+            return status;
+        }
+        if (verbose) {
+            symtab_print(); // Print symbol table content
+        }
         if (astRoot) {
-            printf("--- Abstract Syntax Tree ---\n");
-            // Print the list of statements if astRoot is the head
-            Node* currentStatement = astRoot;
-            while (currentStatement) {
-                printAST(currentStatement, 0); 
-                if (currentStatement->next) {
-                     printf("  (Next Statement...)\n"); // Separator
+            if (verbose) {
+                printf("--- Abstract Syntax Tree ---\n");
+                // Print the list of statements if astRoot is the head
+                Node* currentStatement = astRoot;
+                while (currentStatement) {
+                    printAST(currentStatement, 0); 
+                    if (currentStatement->next) {
+                         printf("  (Next Statement...)\n"); // Separator
+                    }
+                    currentStatement = currentStatement->next;
                 }
-                currentStatement = currentStatement->next;
+                printf("--------------------------\n");
             }
-            printf("--------------------------\n");
             
             // --- Code Generation ---
             FILE* outfile = fopen(out_filename, "w");
             if (!outfile) {
                  perror(out_filename);
-                 freeAST(astRoot); // Still need to free AST
-                 symtab_destroy();
+                 endCompilation(stats, &counts);
                  return 1;
             }
-            printf("Generating C code to %s...\n", out_filename);
-            generateCode(astRoot, outfile);
+            if (verbose) printf("Generating C code to %s...\n", out_filename);
+            stats_phase_begin("codegen");
+            generateCode(astRoot, outfile, &options);
+            long written = ftell(outfile);
             fclose(outfile);
+            stats_phase_end();
+            counts.outputBytes = written > 0 ? (size_t)written : 0;
+            if (verbose) printf("C code generated successfully.\n");
             // -----------------------
 
-            freeAST(astRoot); // Free the entire AST (should handle lists if freeAST is updated)
-            astRoot = NULL;
+            astRoot = NULL; // Freed with compileArena below
         } else {
             printf("Parsing successful, but no AST generated (empty input?).\n");
         }
-        symtab_destroy(); // Clean up symbol table memory
+        endCompilation(stats, &counts);
         return 0; // Success exit code
     } else { // Non-zero indicates a parsing error
         printf("Parsing failed.\n");
-        // Cleanup partially built AST? Might be complex.
-        // Cleanup symbol table
-        symtab_destroy();
+        // Partially built AST, symbols and names all live in the arena
+        endCompilation(stats, &counts);
         return 1; // Failure exit code
     }
-} 
\ No newline at end of file
+}
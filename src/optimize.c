@@ -0,0 +1,216 @@
+#include "optimize.h"
+#include "symtab.h"
+#include <stdio.h>  // For fprintf
+#include <stdlib.h> // For realloc, free, exit
+#include <string.h> // For strcmp
+#include <math.h>   // For signbit
+
+// --- Constant Environment ---
+// Scalar variables known to hold a constant at the current program point.
+// The value lives in the Symbol (const_known/const_value); every change is
+// recorded in an undo log so that branches can be analysed from the same
+// starting state and rolled back afterwards.
+
+typedef struct {
+    Symbol* sym;
+    int known;
+    double value;
+} ConstUndo;
+
+static ConstUndo* undoLog = NULL;
+static size_t undoCount = 0, undoCapacity = 0;
+
+static void setConst(Symbol* sym, int known, double value) {
+    if (!sym) return;
+    if (undoCount == undoCapacity) {
+        undoCapacity = undoCapacity ? 2 * undoCapacity : 256;
+        undoLog = (ConstUndo*)realloc(undoLog, undoCapacity * sizeof(ConstUndo));
+        if (!undoLog) { fprintf(stderr, "Memory allocation error in optimizer\n"); exit(EXIT_FAILURE); }
+    }
+    undoLog[undoCount].sym = sym;
+    undoLog[undoCount].known = sym->const_known;
+    undoLog[undoCount].value = sym->const_value;
+    undoCount++;
+    sym->const_known = known;
+    sym->const_value = value;
+}
+
+// Restores the environment to the state when the log held `mark` entries
+static void rollbackConsts(size_t mark) {
+    while (undoCount > mark) {
+        ConstUndo* u = &undoLog[--undoCount];
+        u->sym->const_known = u->known;
+        u->sym->const_value = u->value;
+    }
+}
+
+// Forgets every variable assigned anywhere in the statement list (loop bodies, branches)
+static void killAssigned(Node* stmt) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN: {
+                Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+                if (sym && sym->const_known) setConst(sym, 0, 0.0);
+                break;
+            }
+            case NODE_IF:
+                killAssigned(stmt->data.ifStmt.then_branch);
+                killAssigned(stmt->data.ifStmt.else_branch);
+                break;
+            case NODE_WHILE:
+                killAssigned(stmt->data.whileStmt.body);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// --- Expression Rewriting ---
+
+// Replaces node by its operand `child` in place, keeping node's list link
+static void replaceWith(Node* node, Node* child) {
+    Node* next = node->next;
+    *node = *child;
+    node->next = next;
+}
+
+static void makeNumber(Node* node, double value) {
+    node->type = NODE_NUM;
+    node->data.dval = value;
+}
+
+static int isNumber(Node* node, double value) {
+    return node && node->type == NODE_NUM && node->data.dval == value;
+}
+
+// Optimizes an expression in place. `substitute` is 0 for direct arguments of
+// calls, which built-ins such as load_vector or print_vector read as names.
+static void optimizeExpr(Node* node, int substitute) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_ID: {
+            Symbol* sym = symtab_lookup(node->data.id.sval);
+            if (substitute && sym && sym->const_known) makeNumber(node, sym->const_value);
+            break;
+        }
+        case NODE_UNARYOP: {
+            Node* operand = node->data.unaryOp.operand;
+            optimizeExpr(operand, 1);
+            if (node->data.unaryOp.op != OP_UMINUS || !operand) break;
+            if (operand->type == NODE_NUM) {
+                makeNumber(node, -operand->data.dval);
+            } else if (operand->type == NODE_UNARYOP && operand->data.unaryOp.op == OP_UMINUS) {
+                replaceWith(node, operand->data.unaryOp.operand); // -(-x) -> x
+            }
+            break;
+        }
+        case NODE_BINOP: {
+            Node* left = node->data.binOp.left;
+            Node* right = node->data.binOp.right;
+            optimizeExpr(left, 1);
+            optimizeExpr(right, 1);
+            if (!left || !right) break;
+            if (left->type == NODE_NUM && right->type == NODE_NUM) {
+                double a = left->data.dval, b = right->data.dval;
+                switch (node->data.binOp.op) {
+                    case OP_PLUS:  makeNumber(node, a + b); break;
+                    case OP_MINUS: makeNumber(node, a - b); break;
+                    case OP_STAR:  makeNumber(node, a * b); break;
+                    case OP_DIV:   makeNumber(node, a / b); break;
+                    case OP_LT:    makeNumber(node, a < b); break;
+                    case OP_GT:    makeNumber(node, a > b); break;
+                    case OP_LE:    makeNumber(node, a <= b); break;
+                    case OP_GE:    makeNumber(node, a >= b); break;
+                    case OP_EQ:    makeNumber(node, a == b); break;
+                    case OP_NE:    makeNumber(node, a != b); break;
+                    default: break;
+                }
+                break;
+            }
+            // Identities exact for every double (x + 0 is not one: it turns -0 into +0)
+            switch (node->data.binOp.op) {
+                case OP_STAR:
+                    if (isNumber(right, 1.0)) replaceWith(node, left);
+                    else if (isNumber(left, 1.0)) replaceWith(node, right);
+                    break;
+                case OP_DIV:
+                    if (isNumber(right, 1.0)) replaceWith(node, left);
+                    break;
+                case OP_MINUS: // x - (+0) is x for every x, including -0
+                    if (right->type == NODE_NUM && right->data.dval == 0.0 && !signbit(right->data.dval)) replaceWith(node, left);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+        case NODE_VEC:
+            for (size_t i = 0; i < node->data.vec.count; ++i) optimizeExpr(node->data.vec.elements[i], 1);
+            break;
+        case NODE_FUNC_CALL: { // create_vector takes a number: a constant length becomes known statically
+            int byValue = strcmp(node->data.funcCall.name, "create_vector") == 0;
+            for (Node* arg = node->data.funcCall.args; arg; arg = arg->next) optimizeExpr(arg, byValue);
+            break;
+        }
+        case NODE_INDEX:
+            optimizeExpr(node->data.index.index, 1);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Statements ---
+
+static void optimizeStatements(Node* stmt) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN: {
+                Node* value = stmt->data.assignOp.value;
+                optimizeExpr(value, 1);
+                Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+                if (value && value->type == NODE_NUM) setConst(sym, 1, value->data.dval);
+                else if (sym && sym->const_known) setConst(sym, 0, 0.0);
+                break;
+            }
+            case NODE_INDEX_ASSIGN: // Vectors are never constants: nothing to forget
+                optimizeExpr(stmt->data.index.index, 1);
+                optimizeExpr(stmt->data.index.value, 1);
+                break;
+            case NODE_IF: {
+                optimizeExpr(stmt->data.ifStmt.condition, 1);
+                size_t mark = undoCount;
+                optimizeStatements(stmt->data.ifStmt.then_branch);
+                rollbackConsts(mark);
+                optimizeStatements(stmt->data.ifStmt.else_branch);
+                rollbackConsts(mark);
+                // Either branch may have run: its assignments are no longer known
+                killAssigned(stmt->data.ifStmt.then_branch);
+                killAssigned(stmt->data.ifStmt.else_branch);
+                break;
+            }
+            case NODE_WHILE: {
+                // The condition and body also see values from earlier iterations
+                killAssigned(stmt->data.whileStmt.body);
+                optimizeExpr(stmt->data.whileStmt.condition, 1);
+                size_t mark = undoCount;
+                optimizeStatements(stmt->data.whileStmt.body);
+                rollbackConsts(mark);
+                break;
+            }
+            default:
+                optimizeExpr(stmt, 1);
+                break;
+        }
+    }
+}
+
+void optimizeAST(Node* astRoot) {
+    optimizeStatements(astRoot);
+    // Leave no stale constants behind for later passes
+    rollbackConsts(0);
+    free(undoLog);
+    undoLog = NULL;
+    undoCount = undoCapacity = 0;
+}
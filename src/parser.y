@@ -18,23 +18,26 @@ extern int yylineno;
 // Define the type of values associated with tokens/rules
 %union {
     double dval; // For lexer NUM value (before node creation)
-    char*  sval; // For lexer ID value (before node creation)
+    const char* sval; // For lexer ID value (interned by the lexer)
     Node*  node; // AST Node pointer (used by most parser rules)
+    struct { Node* head; Node* tail; } list; // List under construction (tail kept for O(1) appends)
 }
 
 // Declare token types
-%token <node> NUM      
+%token <dval> NUM      
 %token <sval> ID       
 %token T_EOF 0  
 %token T_IF             // Keyword tokens
 %token T_ELSE
 %token T_WHILE
+%token T_LE T_GE T_EQ T_NE // Comparison operators of two characters
 
 // Declare types for non-terminals
-%type <node> program statement_list statement assignment_statement expression_statement 
+%type <node> program statement assignment_statement expression_statement 
 %type <node> if_statement while_statement block
-%type <node> expr term factor vector_literal expr_list optional_expr_list
-%type <node> arg_list optional_arg_list // For function call arguments
+%type <node> expr arith_expr term factor vector_literal expr_list optional_expr_list
+%type <node> optional_arg_list // For function call arguments
+%type <list> statement_list arg_list
 
 // Define operator precedence and associativity
 // Lowest precedence at the top
@@ -49,23 +52,20 @@ extern int yylineno;
 
 // Start symbol: a program is a list of statements
 program: statement_list 
-            { astRoot = $1; /* Assign the final statement list to root */ }
+            { astRoot = $1.head; /* Assign the final statement list to root */ }
        ;
 
 statement_list: /* empty */ 
-                  { $$ = NULL; }
+                  { $$.head = NULL; $$.tail = NULL; }
               | statement_list statement 
                   { 
-                    // Append statement to the list
-                    if ($1 == NULL) { 
-                        $$ = $2; // First statement
-                    } else {
-                        Node* current = $1;
-                        while (current->next != NULL) {
-                            current = current->next;
-                        }
-                        current->next = $2;
-                        $$ = $1; // Return head of the list
+                    // Append statement to the list in O(1) via the tail pointer
+                    $$ = $1;
+                    if ($2 != NULL) {
+                        if ($$.head == NULL) $$.head = $2; // First statement
+                        else $$.tail->next = $2;
+                        // A block statement is itself a list: move the tail to its end
+                        for ($$.tail = $2; $$.tail->next != NULL; $$.tail = $$.tail->next) { }
                     }
                   }
               ;
@@ -80,9 +80,13 @@ statement: assignment_statement { $$ = $1; }
 assignment_statement: ID '=' expr ';' 
                       { 
                         Symbol* sym = symtab_insert($1, TYPE_UNDEFINED, @1.first_line); 
-                        // Pass the original sval ($1) to newNodeAssign, which will strdup it.
-                        $$ = newNodeAssign(@$.lineno, $1, $3);
-                        // Do NOT free($1) here; symtab and AST node own copies.
+                        // $1 is interned: the symbol table and AST node share it
+                        $$ = newNodeAssign(@$.first_line, $1, $3);
+                      }
+                    | ID '[' expr ']' '=' expr ';' // Element assignment
+                      {
+                        symtab_insert($1, TYPE_UNDEFINED, @1.first_line);
+                        $$ = newNodeIndexAssign(@$.first_line, $1, $3, $6);
                       }
                     ;
 
@@ -106,38 +110,51 @@ while_statement: T_WHILE '(' expr ')' block
 
 // Block of statements
 block: '{' statement_list '}' 
-         { $$ = $2; /* Return the head of the statement list within the block */ }
+         { $$ = $2.head; /* Return the head of the statement list within the block */ }
      ;
 
-expr: expr '+' term   { $$ = newNodeBinaryOp(@$.lineno, OP_PLUS, $1, $3); }
-    | expr '-' term   { $$ = newNodeBinaryOp(@$.lineno, OP_MINUS, $1, $3); }
-    | term            { $$ = $1; }
+// Comparisons evaluate to 1 or 0 and do not chain
+expr: arith_expr '<' arith_expr  { $$ = newNodeBinaryOp(@$.first_line, OP_LT, $1, $3); }
+    | arith_expr '>' arith_expr  { $$ = newNodeBinaryOp(@$.first_line, OP_GT, $1, $3); }
+    | arith_expr T_LE arith_expr { $$ = newNodeBinaryOp(@$.first_line, OP_LE, $1, $3); }
+    | arith_expr T_GE arith_expr { $$ = newNodeBinaryOp(@$.first_line, OP_GE, $1, $3); }
+    | arith_expr T_EQ arith_expr { $$ = newNodeBinaryOp(@$.first_line, OP_EQ, $1, $3); }
+    | arith_expr T_NE arith_expr { $$ = newNodeBinaryOp(@$.first_line, OP_NE, $1, $3); }
+    | arith_expr                 { $$ = $1; }
     ;
 
-term: term '*' factor { $$ = newNodeBinaryOp(@$.lineno, OP_STAR, $1, $3); }
-    | term '/' factor { $$ = newNodeBinaryOp(@$.lineno, OP_DIV, $1, $3); }
+arith_expr: arith_expr '+' term { $$ = newNodeBinaryOp(@$.first_line, OP_PLUS, $1, $3); }
+          | arith_expr '-' term { $$ = newNodeBinaryOp(@$.first_line, OP_MINUS, $1, $3); }
+          | term                { $$ = $1; }
+          ;
+
+term: term '*' factor { $$ = newNodeBinaryOp(@$.first_line, OP_STAR, $1, $3); }
+    | term '/' factor { $$ = newNodeBinaryOp(@$.first_line, OP_DIV, $1, $3); }
     | factor          { $$ = $1; }
     ;
 
 factor: '(' expr ')'           { $$ = $2; }
-      | '-' factor %prec UMINUS { $$ = newNodeUnaryOp(@$.lineno, OP_UMINUS, $2); } 
-      | NUM                      { $$ = newNodeNum(@$.lineno, $1); }
+      | '-' factor %prec UMINUS { $$ = newNodeUnaryOp(@$.first_line, OP_UMINUS, $2); } 
+      | NUM                      { $$ = newNodeNum(@$.first_line, $1); }
       | ID                       
           { 
-            symtab_insert($1, TYPE_UNDEFINED, @$.lineno);
-            $$ = newNodeID(@$.lineno, $1); 
+            symtab_insert($1, TYPE_UNDEFINED, @$.first_line);
+            $$ = newNodeID(@$.first_line, $1); 
+          }
+      | ID '[' expr ']'          // Element read
+          {
+            symtab_insert($1, TYPE_UNDEFINED, @$.first_line);
+            $$ = newNodeIndex(@$.first_line, $1, $3);
           }
       | vector_literal           { $$ = $1; }
       | ID '(' optional_arg_list ')' // Function call
           { 
-            // Need to handle potential re-use of $1 ID string
-            $$ = newNodeFuncCall(@1.first_line, $1, $3); 
-            free($1); // Free the ID string from lexer, newNodeFuncCall strdup'd it
+            $$ = newNodeFuncCall(@1.first_line, $1, $3); // $1 is interned, not copied
           }
       ;
 
 vector_literal: '[' optional_expr_list ']' 
-                  { $$ = $2 ? $2 : newNodeVec(@$.lineno, NULL); /* Handle empty vector */ }
+                  { $$ = $2 ? $2 : newNodeVec(@$.first_line, NULL); /* Handle empty vector */ }
                 ;
 
 optional_expr_list: /* empty */ 
@@ -152,7 +169,7 @@ optional_expr_list: /* empty */
 expr_list: expr 
              { 
                // Create a new vector node with the first expression
-               $$ = newNodeVec(@$.lineno, $1); 
+               $$ = newNodeVec(@$.first_line, $1); 
              }
          | expr_list ',' expr 
              { 
@@ -165,24 +182,21 @@ expr_list: expr
 optional_arg_list: /* empty */ 
                      { $$ = NULL; }
                  | arg_list 
-                     { $$ = $1; }
+                     { $$ = $1.head; }
                  ;
 
 arg_list: expr 
             { 
-              $$ = $1;       // First argument node
-              $$->next = NULL; // Ensure it's the end of the list so far
+              $$.head = $$.tail = $1; // First argument node
+              $1->next = NULL;        // Ensure it's the end of the list so far
             }
         | arg_list ',' expr 
             { 
-              // Append $3 to the list headed by $1
-              Node* current = $1;
-              while (current->next != NULL) { // Find end of list
-                  current = current->next;
-              }
-              current->next = $3; // Append new argument
+              // Append $3 after the tail of the list headed by $1
+              $1.tail->next = $3;
               $3->next = NULL;    // Ensure it's the new end
-              $$ = $1;            // Return the head of the list
+              $$.head = $1.head;  // Return the head of the list
+              $$.tail = $3;
             }
         ;
 
@@ -0,0 +1,47 @@
+#include "runtime.h"
+#include <string.h>
+
+// The runtime itself lives in runtime/wizurt.c and is built once into
+// libwizurt. Generated programs include its header and link against it, or,
+// with --inline-runtime, carry a copy of its source embedded at build time.
+
+// Library header and source text (generated from runtime/ by the Makefile)
+extern const char wizurt_header_source[];
+extern const char wizurt_library_source[];
+
+// Writes the runtime source with its #include "wizurt.h" replaced by the header
+static void emitInlineRuntime(FILE* outfile) {
+    static const char includeLine[] = "#include \"wizurt.h\"\n";
+    const char* include = strstr(wizurt_library_source, includeLine);
+    fprintf(outfile, "#define WZ_INLINE_RUNTIME // Runtime compiled into this program (wizuallc --inline-runtime)\n");
+    if (!include) { // Not expected: the library source always includes its header
+        fputs(wizurt_header_source, outfile);
+        fputs(wizurt_library_source, outfile);
+        return;
+    }
+    fwrite(wizurt_library_source, 1, (size_t)(include - wizurt_library_source), outfile);
+    fputs(wizurt_header_source, outfile);
+    fputs(include + sizeof(includeLine) - 1, outfile);
+}
+
+void emitRuntime(FILE* outfile, const CodegenOptions* options) {
+    if (options->inlineRuntime) {
+        emitInlineRuntime(outfile);
+    } else {
+        fprintf(outfile, "#include \"wizurt.h\" // WizuAll runtime: link with -lwizurt -lm -pthread -fopenmp\n");
+    }
+    if (options->parallel) {
+        fprintf(outfile, "#if !defined(_OPENMP) && defined(__GNUC__)\n");
+        fprintf(outfile, "#warning \"generated with --parallel: compile with -fopenmp to run vector operations on all cores\"\n");
+        fprintf(outfile, "#endif\n");
+    }
+    fprintf(outfile, "\n");
+}
+
+void emitRuntimeConfig(FILE* outfile, const CodegenOptions* options) {
+    fprintf(outfile, "    // Runtime configuration (wizuallc options)\n");
+    fprintf(outfile, "    wz_cache_enabled = %d; wz_compensated_sum = %d; wz_parallel = %d;\n",
+            options->enableCache, options->compensatedSum, options->parallel);
+    fprintf(outfile, "    wz_plot_points = %d; wz_plot_decimate = %d;\n\n",
+            options->plotPoints, options->plotDecimate);
+}
@@ -0,0 +1,701 @@
+#include "semantic.h"
+#include "symtab.h"
+#include <stdio.h>  // For fprintf, vfprintf
+#include <stdlib.h> // For realloc, free, exit
+#include <stdarg.h> // For va_list
+#include <string.h> // For strcmp
+
+static int errorCount = 0;
+
+static void semanticError(int lineno, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "Semantic Error line %d: ", lineno);
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+    errorCount++;
+}
+
+// --- Built-in Signatures ---
+
+typedef enum {
+    RESULT_SCALAR,
+    RESULT_VECTOR,
+    RESULT_NONE // Statement only
+} BuiltinResult;
+
+typedef struct {
+    const char* name;
+    int argc;       // Expected number of arguments, -1 if not checked
+    int vectorArgs; // Every argument must be a vector variable
+    BuiltinResult result;
+} Builtin;
+
+static const Builtin builtins[] = {
+    { "load_vector",  2,  0, RESULT_VECTOR },
+    { "create_vector", 1, 0, RESULT_VECTOR },
+    { "length",       1,  1, RESULT_SCALAR },
+    { "average",      1,  1, RESULT_SCALAR },
+    { "mean",         1,  1, RESULT_SCALAR },
+    { "sum",          1,  1, RESULT_SCALAR },
+    { "min_val",      1,  1, RESULT_SCALAR },
+    { "max_val",      1,  1, RESULT_SCALAR },
+    { "variance",     1,  1, RESULT_SCALAR },
+    { "stddev",       1,  1, RESULT_SCALAR },
+    { "argmin",       1,  1, RESULT_SCALAR },
+    { "argmax",       1,  1, RESULT_SCALAR },
+    { "print_vector", 1,  1, RESULT_NONE },
+    { "plot_xy",      2,  1, RESULT_NONE },
+    { "save_plot",    1,  0, RESULT_NONE },
+    { "histogram",    -1, 0, RESULT_NONE },
+};
+
+static const Builtin* findBuiltin(const char* name) {
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); ++i) {
+        if (strcmp(builtins[i].name, name) == 0) return &builtins[i];
+    }
+    return NULL;
+}
+
+// --- Type Inference ---
+
+// Returns 1 if the expression evaluates to a Vector (based on current symbol types)
+static int isVectorValued(Node* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_ID: {
+            Symbol* sym = symtab_lookup(node->data.id.sval);
+            return sym && sym->type == TYPE_VECTOR;
+        }
+        case NODE_BINOP:
+            return isVectorValued(node->data.binOp.left) || isVectorValued(node->data.binOp.right);
+        case NODE_UNARYOP:
+            return isVectorValued(node->data.unaryOp.operand);
+        case NODE_VEC:
+            return 1;
+        case NODE_FUNC_CALL: {
+            const Builtin* b = findBuiltin(node->data.funcCall.name);
+            return b && b->result == RESULT_VECTOR;
+        }
+        default:
+            return 0;
+    }
+}
+
+// Marks every variable assigned a vector-valued expression as TYPE_VECTOR.
+// Runs to a fixpoint so that chains like `y = x * 2; z = y + 1;` resolve
+// regardless of statement order. Returns the number of symbols changed.
+static int markVectorSymbols(Node* stmt) {
+    int changed = 0;
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN:
+                if (isVectorValued(stmt->data.assignOp.value)) {
+                    Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+                    if (sym && sym->type != TYPE_VECTOR) {
+                        sym->type = TYPE_VECTOR;
+                        changed++;
+                    }
+                }
+                break;
+            case NODE_INDEX_ASSIGN: { // Only vectors have elements
+                Symbol* sym = symtab_lookup(stmt->data.index.name);
+                if (sym && sym->type != TYPE_VECTOR) {
+                    sym->type = TYPE_VECTOR;
+                    changed++;
+                }
+                break;
+            }
+            case NODE_IF:
+                changed += markVectorSymbols(stmt->data.ifStmt.then_branch);
+                changed += markVectorSymbols(stmt->data.ifStmt.else_branch);
+                break;
+            case NODE_WHILE:
+                changed += markVectorSymbols(stmt->data.whileStmt.body);
+                break;
+            default:
+                break;
+        }
+    }
+    return changed;
+}
+
+// --- Length Environment ---
+// The length (or length class) of each vector variable at the current program
+// point lives in the Symbol; as in the optimizer, changes are undo-logged so
+// branches start from the same state. A length class names "the length of
+// the vector some load produced": vectors computed from it share the class and
+// are known to match it even though the number itself is only known at run time.
+// Scalars use the same fields for the vector length they are known to equal,
+// plus whether they are known to be non-negative (see Index Ranges below).
+
+typedef struct {
+    Symbol* sym;
+    long length;
+    int length_class;
+    int nonneg;
+} LengthUndo;
+
+static LengthUndo* undoLog = NULL;
+static size_t undoCount = 0, undoCapacity = 0;
+static int lastLengthClass = 0;
+
+static void setFacts(Symbol* sym, long length, int lengthClass, int nonneg) {
+    if (!sym) return;
+    if (undoCount == undoCapacity) {
+        undoCapacity = undoCapacity ? 2 * undoCapacity : 256;
+        undoLog = (LengthUndo*)realloc(undoLog, undoCapacity * sizeof(LengthUndo));
+        if (!undoLog) { fprintf(stderr, "Memory allocation error in semantic analysis\n"); exit(EXIT_FAILURE); }
+    }
+    undoLog[undoCount].sym = sym;
+    undoLog[undoCount].length = sym->length;
+    undoLog[undoCount].length_class = sym->length_class;
+    undoLog[undoCount].nonneg = sym->nonneg;
+    undoCount++;
+    sym->length = length;
+    sym->length_class = lengthClass;
+    sym->nonneg = nonneg;
+}
+
+static void setLength(Symbol* sym, long length, int lengthClass) {
+    if (sym) setFacts(sym, length, lengthClass, sym->nonneg);
+}
+
+static void rollbackLengths(size_t mark) {
+    while (undoCount > mark) {
+        LengthUndo* u = &undoLog[--undoCount];
+        u->sym->length = u->length;
+        u->sym->length_class = u->length_class;
+        u->sym->nonneg = u->nonneg;
+    }
+}
+
+// Forgets the length (or scalar facts) of every variable assigned anywhere in the
+// statement list; element assignments leave a vector's length unchanged
+static void killAssigned(Node* stmt) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN: {
+                Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+                if (sym && (sym->length >= 0 || sym->length_class || sym->nonneg)) setFacts(sym, -1, 0, 0);
+                break;
+            }
+            case NODE_IF:
+                killAssigned(stmt->data.ifStmt.then_branch);
+                killAssigned(stmt->data.ifStmt.else_branch);
+                break;
+            case NODE_WHILE:
+                killAssigned(stmt->data.whileStmt.body);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int sameVectorLength(const Node* a, const Node* b) {
+    if (a->length >= 0 && a->length == b->length) return 1;
+    return a->lengthClass != 0 && a->lengthClass == b->lengthClass;
+}
+
+static void setShape(Node* node, int isVector, long length, int lengthClass) {
+    node->isVector = isVector;
+    node->length = isVector ? length : -1;
+    node->lengthClass = isVector ? lengthClass : 0;
+}
+
+// --- Expressions ---
+
+// Where a call appears: built-ins without a result are statements, and
+// load_vector and create_vector must be assigned directly to a variable
+typedef enum { IN_EXPRESSION, AS_STATEMENT, AS_ASSIGNED_VALUE } CallContext;
+
+static void analyzeExpr(Node* node, CallContext context);
+static int scalarLength(Node* e, long* length, int* lengthClass);
+static void analyzeIndex(Node* node);
+
+static void analyzeCall(Node* node, CallContext context) {
+    const char* name = node->data.funcCall.name;
+    const Builtin* b = findBuiltin(name);
+    int argc = 0;
+    for (Node* arg = node->data.funcCall.args; arg; arg = arg->next) argc++;
+    if (!b) { // Passed through to C as is
+        for (Node* arg = node->data.funcCall.args; arg; arg = arg->next) analyzeExpr(arg, IN_EXPRESSION);
+        setShape(node, 0, -1, 0);
+        return;
+    }
+    if (b->result == RESULT_NONE && context != AS_STATEMENT) {
+        semanticError(node->lineno, "%s does not return a value", name);
+    }
+    if (b->argc >= 0 && argc != b->argc) {
+        semanticError(node->lineno, "%s expects %d argument%s, got %d", name, b->argc, b->argc == 1 ? "" : "s", argc);
+    }
+
+    if (strcmp(name, "load_vector") == 0) {
+        Node* file = node->data.funcCall.args;
+        Node* column = file ? file->next : NULL;
+        if (context == IN_EXPRESSION) {
+            semanticError(node->lineno, "load_vector can only be assigned directly to a variable");
+        }
+        if (file && file->type != NODE_ID) {
+            semanticError(node->lineno, "load_vector expects a file name as its first argument");
+        }
+        if (column && (column->type != NODE_NUM || column->data.dval < 0 || column->data.dval > 1e9 ||
+                       column->data.dval != (double)(long)column->data.dval)) {
+            semanticError(node->lineno, "load_vector expects a constant column index as its second argument");
+        }
+        setShape(node, 1, -1, ++lastLengthClass); // A fresh, run-time length
+        return;
+    }
+    if (strcmp(name, "create_vector") == 0) {
+        Node* size = node->data.funcCall.args;
+        long length = -1;
+        int lengthClass = 0;
+        if (context != AS_ASSIGNED_VALUE) {
+            semanticError(node->lineno, "create_vector can only be assigned directly to a variable");
+        }
+        analyzeExpr(size, IN_EXPRESSION);
+        if (size && size->isVector) {
+            semanticError(node->lineno, "create_vector expects a scalar length, not a vector");
+        } else if (size && size->type == NODE_NUM && !scalarLength(size, &length, &lengthClass)) {
+            semanticError(node->lineno, "create_vector expects a non-negative integer length");
+        } else if (size && !scalarLength(size, &length, &lengthClass)) {
+            // The run-time check makes the length exactly the argument's value
+            lengthClass = ++lastLengthClass;
+            if (size->type == NODE_ID) setLength(symtab_lookup(size->data.id.sval), -1, lengthClass);
+        }
+        setShape(node, 1, length, lengthClass);
+        return;
+    }
+
+    int index = 0;
+    for (Node* arg = node->data.funcCall.args; arg; arg = arg->next) {
+        index++;
+        if (!b->vectorArgs) continue;
+        analyzeExpr(arg, IN_EXPRESSION);
+        if (arg->type != NODE_ID || !arg->isVector) {
+            semanticError(node->lineno, "%s expects a vector variable as argument %d", name, index);
+        }
+    }
+    if (strcmp(name, "plot_xy") == 0 && argc == 2) {
+        Node* x = node->data.funcCall.args;
+        Node* y = x->next;
+        if (x->isVector && y->isVector && x->length >= 0 && y->length >= 0 && x->length != y->length) {
+            semanticError(node->lineno, "plot_xy vectors differ in length (%ld vs %ld)", x->length, y->length);
+        }
+    }
+    setShape(node, 0, -1, 0);
+}
+
+static void analyzeExpr(Node* node, CallContext context) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_NUM:
+            setShape(node, 0, -1, 0);
+            break;
+        case NODE_ID: {
+            Symbol* sym = symtab_lookup(node->data.id.sval);
+            if (sym && sym->type == TYPE_VECTOR) setShape(node, 1, sym->length, sym->length_class);
+            else setShape(node, 0, -1, 0);
+            break;
+        }
+        case NODE_UNARYOP: {
+            Node* operand = node->data.unaryOp.operand;
+            analyzeExpr(operand, IN_EXPRESSION);
+            if (operand) setShape(node, operand->isVector, operand->length, operand->lengthClass);
+            break;
+        }
+        case NODE_BINOP: {
+            Node* left = node->data.binOp.left;
+            Node* right = node->data.binOp.right;
+            analyzeExpr(left, IN_EXPRESSION);
+            analyzeExpr(right, IN_EXPRESSION);
+            if (!left || !right) break;
+            if (left->isVector && right->isVector) {
+                if (left->length >= 0 && right->length >= 0 && left->length != right->length) {
+                    semanticError(node->lineno, "vector length mismatch (%ld vs %ld elements)", left->length, right->length);
+                }
+                // After the run-time check (if any) both operands have the same length. The
+                // shape is taken from one operand only: a length from one side and a class
+                // from the other would make codegen skip the check that links them.
+                Node* from = (left->length >= 0 || left->lengthClass) ? left : right;
+                setShape(node, 1, from->length, from->lengthClass);
+            } else if (left->isVector) {
+                setShape(node, 1, left->length, left->lengthClass);
+            } else if (right->isVector) {
+                setShape(node, 1, right->length, right->lengthClass);
+            } else {
+                setShape(node, 0, -1, 0);
+            }
+            break;
+        }
+        case NODE_VEC:
+            for (size_t i = 0; i < node->data.vec.count; ++i) {
+                Node* element = node->data.vec.elements[i];
+                analyzeExpr(element, IN_EXPRESSION);
+                if (element && element->isVector) {
+                    semanticError(element->lineno, "vector literal elements must be scalars");
+                }
+            }
+            setShape(node, 1, (long)node->data.vec.count, 0);
+            break;
+        case NODE_FUNC_CALL:
+            analyzeCall(node, context);
+            break;
+        case NODE_INDEX:
+            analyzeIndex(node);
+            setShape(node, 0, -1, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Index Ranges ---
+// An element access v[i] is checked against v.size at run time unless it is
+// proven in bounds: a constant index within a known length, or the counter i of
+// an enclosing `while (i < n)` (or `if`), where n is known to equal the length
+// of v, i is never negative, and i is not assigned between the test and the
+// access. Inside a loop, vectors and bounds assigned in the body have already
+// been forgotten (killAssigned), so a proven length holds for every iteration.
+
+typedef struct {
+    Symbol* counter; // i in `i < n`
+    long length;     // Vector length n is known to equal (-1 unknown)
+    int lengthClass; // Length class n is known to equal (0 none)
+} IndexRange;
+
+// Returns 1 if the scalar expression is known to equal a vector length, stored in length/lengthClass
+static int scalarLength(Node* e, long* length, int* lengthClass) {
+    *length = -1;
+    *lengthClass = 0;
+    if (!e || e->isVector) return 0;
+    switch (e->type) {
+        case NODE_NUM:
+            if (e->data.dval >= 0 && e->data.dval <= 1e15 && e->data.dval == (double)(long)e->data.dval) *length = (long)e->data.dval;
+            break;
+        case NODE_ID: {
+            Symbol* sym = symtab_lookup(e->data.id.sval);
+            if (sym && sym->type != TYPE_VECTOR) {
+                *length = sym->length;
+                *lengthClass = sym->length_class;
+            }
+            break;
+        }
+        case NODE_FUNC_CALL: {
+            Node* arg = e->data.funcCall.args;
+            if (strcmp(e->data.funcCall.name, "length") == 0 && arg && arg->isVector) {
+                *length = arg->length;
+                *lengthClass = arg->lengthClass;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return *length >= 0 || *lengthClass != 0;
+}
+
+// Returns 1 if the scalar expression is a number >= 0, never NaN; `assume` is taken to be one.
+// Sums of such numbers stay in [0, inf], but products and quotients can be NaN (0 * inf).
+static int isNonNegative(Node* e, const Symbol* assume) {
+    if (!e || e->isVector) return 0;
+    switch (e->type) {
+        case NODE_NUM:
+            return e->data.dval >= 0;
+        case NODE_ID: {
+            Symbol* sym = symtab_lookup(e->data.id.sval);
+            return sym && sym->type != TYPE_VECTOR && (sym == assume || sym->nonneg);
+        }
+        case NODE_BINOP:
+            switch (e->data.binOp.op) {
+                case OP_PLUS:
+                    return isNonNegative(e->data.binOp.left, assume) && isNonNegative(e->data.binOp.right, assume);
+                case OP_LT: case OP_GT: case OP_LE: case OP_GE: case OP_EQ: case OP_NE:
+                    return 1; // 0 or 1
+                default:
+                    return 0;
+            }
+        case NODE_FUNC_CALL:
+            return strcmp(e->data.funcCall.name, "length") == 0;
+        default:
+            return 0;
+    }
+}
+
+// Returns 1 if the statement list assigns sym anywhere
+static int assigns(Node* stmt, const Symbol* sym) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN:
+                if (symtab_lookup(stmt->data.assignOp.name) == sym) return 1;
+                break;
+            case NODE_IF:
+                if (assigns(stmt->data.ifStmt.then_branch, sym) || assigns(stmt->data.ifStmt.else_branch, sym)) return 1;
+                break;
+            case NODE_WHILE:
+                if (assigns(stmt->data.whileStmt.body, sym)) return 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+// Returns 1 if every assignment to counter in the statement list leaves it >= 0, given that it was
+static int keepsNonNegative(Node* stmt, const Symbol* counter) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN:
+                if (symtab_lookup(stmt->data.assignOp.name) == counter && !isNonNegative(stmt->data.assignOp.value, counter)) return 0;
+                break;
+            case NODE_IF:
+                if (!keepsNonNegative(stmt->data.ifStmt.then_branch, counter) ||
+                    !keepsNonNegative(stmt->data.ifStmt.else_branch, counter)) return 0;
+                break;
+            case NODE_WHILE:
+                if (!keepsNonNegative(stmt->data.whileStmt.body, counter)) return 0;
+                break;
+            default:
+                break;
+        }
+    }
+    return 1;
+}
+
+// Returns the scalar i of a condition `i < n` (or `n > i`), NULL for other conditions; n is stored in bound
+static Symbol* rangeCounter(Node* condition, Node** bound) {
+    if (!condition || condition->type != NODE_BINOP) return NULL;
+    Node* counter = condition->data.binOp.left;
+    *bound = condition->data.binOp.right;
+    if (condition->data.binOp.op == OP_GT) {
+        counter = condition->data.binOp.right;
+        *bound = condition->data.binOp.left;
+    } else if (condition->data.binOp.op != OP_LT) {
+        return NULL;
+    }
+    if (!counter || counter->type != NODE_ID) return NULL;
+    Symbol* sym = symtab_lookup(counter->data.id.sval);
+    return sym && sym->type != TYPE_VECTOR ? sym : NULL;
+}
+
+// Fills range from an analyzed condition `i < n` whose bound n is known to equal a vector length
+static int indexRange(Node* condition, IndexRange* range) {
+    Node* bound;
+    range->counter = rangeCounter(condition, &bound);
+    return range->counter && !condition->isVector && scalarLength(bound, &range->length, &range->lengthClass);
+}
+
+// Marks site (v[i]) in bounds if i is the range's counter and v is at least the range's length
+static void markSite(Node* site, const IndexRange* range) {
+    Node* index = site->data.index.index;
+    Symbol* sym = symtab_lookup(site->data.index.name);
+    if (!index || index->type != NODE_ID || symtab_lookup(index->data.id.sval) != range->counter) return;
+    if (!sym || sym->type != TYPE_VECTOR) return;
+    if ((range->lengthClass != 0 && sym->length_class == range->lengthClass) ||
+        (range->length >= 0 && sym->length >= range->length)) {
+        site->data.index.inBounds = 1;
+    }
+}
+
+static void markExprSites(Node* e, const IndexRange* range) {
+    if (!e) return;
+    switch (e->type) {
+        case NODE_BINOP:
+            markExprSites(e->data.binOp.left, range);
+            markExprSites(e->data.binOp.right, range);
+            break;
+        case NODE_UNARYOP:
+            markExprSites(e->data.unaryOp.operand, range);
+            break;
+        case NODE_VEC:
+            for (size_t i = 0; i < e->data.vec.count; ++i) markExprSites(e->data.vec.elements[i], range);
+            break;
+        case NODE_FUNC_CALL:
+            for (Node* arg = e->data.funcCall.args; arg; arg = arg->next) markExprSites(arg, range);
+            break;
+        case NODE_INDEX:
+            markExprSites(e->data.index.index, range);
+            markSite(e, range);
+            break;
+        default:
+            break;
+    }
+}
+
+// Marks the sites in the statement list reached before the counter may have been assigned;
+// *modified is set once it may have been
+static void markStatementSites(Node* stmt, const IndexRange* range, int* modified) {
+    for (; stmt && !*modified; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN:
+                markExprSites(stmt->data.assignOp.value, range);
+                if (symtab_lookup(stmt->data.assignOp.name) == range->counter) *modified = 1;
+                break;
+            case NODE_INDEX_ASSIGN:
+                markExprSites(stmt->data.index.index, range);
+                markExprSites(stmt->data.index.value, range);
+                markSite(stmt, range);
+                break;
+            case NODE_IF: {
+                markExprSites(stmt->data.ifStmt.condition, range);
+                int thenModified = 0, elseModified = 0;
+                markStatementSites(stmt->data.ifStmt.then_branch, range, &thenModified);
+                markStatementSites(stmt->data.ifStmt.else_branch, range, &elseModified);
+                *modified = thenModified || elseModified;
+                break;
+            }
+            case NODE_WHILE:
+                // Later iterations of an inner loop run after its own assignments
+                if (assigns(stmt->data.whileStmt.body, range->counter)) *modified = 1;
+                else {
+                    markExprSites(stmt->data.whileStmt.condition, range);
+                    markStatementSites(stmt->data.whileStmt.body, range, modified);
+                }
+                break;
+            default:
+                markExprSites(stmt, range);
+                break;
+        }
+    }
+}
+
+// Checks v[i] (read or element assignment); a constant index within a known length needs no run-time check
+static void analyzeIndex(Node* node) {
+    const char* name = node->data.index.name;
+    Symbol* sym = symtab_lookup(name);
+    Node* index = node->data.index.index;
+    analyzeExpr(index, IN_EXPRESSION);
+    if (!sym || sym->type != TYPE_VECTOR) {
+        semanticError(node->lineno, "'%s' is not a vector and cannot be indexed", name);
+        return;
+    }
+    if (!index) return;
+    if (index->isVector) {
+        semanticError(node->lineno, "index into '%s' must be a scalar, not a vector", name);
+    } else if (index->type == NODE_NUM && sym->length >= 0) {
+        double i = index->data.dval;
+        if (!(i >= 0 && i < (double)sym->length)) {
+            semanticError(node->lineno, "index %g is out of bounds for '%s' (%ld elements)", i, name, sym->length);
+        } else {
+            node->data.index.inBounds = 1;
+        }
+    }
+}
+
+// --- Statements ---
+
+static void analyzeCondition(Node* condition) {
+    analyzeExpr(condition, IN_EXPRESSION);
+    if (condition && condition->isVector) {
+        semanticError(condition->lineno, "condition must be a scalar, not a vector");
+    }
+}
+
+static void analyzeStatements(Node* stmt) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case NODE_ASSIGN: {
+                Node* value = stmt->data.assignOp.value;
+                Symbol* sym = symtab_lookup(stmt->data.assignOp.name);
+                analyzeExpr(value, AS_ASSIGNED_VALUE);
+                if (!sym || !value) break;
+                if (sym->type == TYPE_VECTOR && !value->isVector) {
+                    semanticError(stmt->lineno, "cannot assign a scalar to '%s', which holds a vector elsewhere", sym->name);
+                    break;
+                }
+                if (sym->type != TYPE_VECTOR) { // Facts for index ranges
+                    long length;
+                    int lengthClass;
+                    scalarLength(value, &length, &lengthClass);
+                    setFacts(sym, length, lengthClass, isNonNegative(value, NULL));
+                    break;
+                }
+                setLength(sym, value->length, value->lengthClass);
+                if (sym->fixed_length == -2) sym->fixed_length = value->length; // First assignment seen
+                else if (sym->fixed_length != value->length) sym->fixed_length = -1;
+                break;
+            }
+            case NODE_INDEX_ASSIGN: {
+                Node* value = stmt->data.index.value;
+                analyzeIndex(stmt);
+                analyzeExpr(value, IN_EXPRESSION);
+                if (value && value->isVector) {
+                    semanticError(stmt->lineno, "cannot store a vector into an element of '%s'", stmt->data.index.name);
+                }
+                break;
+            }
+            case NODE_IF: {
+                analyzeCondition(stmt->data.ifStmt.condition);
+                size_t mark = undoCount;
+                IndexRange range;
+                if (indexRange(stmt->data.ifStmt.condition, &range) && range.counter->nonneg) {
+                    // Vectors the branch assigns no longer match the bound tested here
+                    int modified = 0;
+                    killAssigned(stmt->data.ifStmt.then_branch);
+                    markStatementSites(stmt->data.ifStmt.then_branch, &range, &modified);
+                    rollbackLengths(mark);
+                }
+                analyzeStatements(stmt->data.ifStmt.then_branch);
+                rollbackLengths(mark);
+                analyzeStatements(stmt->data.ifStmt.else_branch);
+                rollbackLengths(mark);
+                // Either branch may have run
+                killAssigned(stmt->data.ifStmt.then_branch);
+                killAssigned(stmt->data.ifStmt.else_branch);
+                break;
+            }
+            case NODE_WHILE: {
+                Node* condition = stmt->data.whileStmt.condition;
+                Node* body = stmt->data.whileStmt.body;
+                Node* bound;
+                Symbol* counter = rangeCounter(condition, &bound);
+                int counterNonNeg = counter && counter->nonneg; // On entry
+                // The condition and body also see vectors from earlier iterations
+                killAssigned(body);
+                analyzeCondition(condition);
+                // The counter stays >= 0 if every assignment in the body keeps it so
+                counterNonNeg = counterNonNeg && keepsNonNegative(body, counter);
+                size_t mark = undoCount;
+                IndexRange range;
+                if (counterNonNeg) {
+                    setFacts(counter, counter->length, counter->length_class, 1);
+                    int modified = 0;
+                    if (indexRange(condition, &range)) markStatementSites(body, &range, &modified);
+                }
+                analyzeStatements(body);
+                rollbackLengths(mark);
+                if (counterNonNeg) setFacts(counter, counter->length, counter->length_class, 1); // Also on exit
+                break;
+            }
+            default:
+                analyzeExpr(stmt, AS_STATEMENT);
+                break;
+        }
+    }
+}
+
+int analyzeSemantics(Node* astRoot) {
+    errorCount = 0;
+    while (markVectorSymbols(astRoot) > 0) { }
+    for (Symbol* sym = globalSymTab ? globalSymTab->head : NULL; sym; sym = sym->next) {
+        if (sym->type != TYPE_VECTOR) sym->type = TYPE_SCALAR;
+        sym->length = 0; // Declared empty (scalars start at 0)
+        sym->length_class = 0;
+        sym->nonneg = sym->type == TYPE_SCALAR;
+        sym->fixed_length = -2; // No assignment seen yet
+    }
+
+    analyzeStatements(astRoot);
+
+    rollbackLengths(0);
+    free(undoLog);
+    undoLog = NULL;
+    undoCount = undoCapacity = 0;
+    for (Symbol* sym = globalSymTab ? globalSymTab->head : NULL; sym; sym = sym->next) {
+        if (sym->fixed_length == -2) sym->fixed_length = -1;
+    }
+    return errorCount;
+}
@@ -0,0 +1,70 @@
+#include "stats.h"
+#include <string.h>       // For memset
+#include <time.h>         // For clock_gettime
+#include <sys/resource.h> // For getrusage
+#ifdef __GLIBC__
+#include <malloc.h>       // For mallinfo2
+#endif
+#include "arena.h"
+
+#define STATS_MAX_PHASES 16
+
+static PhaseStats phases[STATS_MAX_PHASES];
+static int phaseCount = 0;
+static struct timespec phaseStart;
+static size_t phaseArenaStart = 0;
+
+static double elapsedSince(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Bytes currently allocated with malloc, where the C library can tell
+static size_t heapInUse(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+void stats_phase_begin(const char* name) {
+    if (phaseCount == STATS_MAX_PHASES) return;
+    memset(&phases[phaseCount], 0, sizeof(PhaseStats));
+    phases[phaseCount].name = name;
+    phaseArenaStart = compileArena.bytes;
+    clock_gettime(CLOCK_MONOTONIC, &phaseStart);
+}
+
+PhaseStats* stats_phase_end(void) {
+    static PhaseStats overflow; // Phases past STATS_MAX_PHASES are not reported
+    if (phaseCount == STATS_MAX_PHASES) return &overflow;
+    PhaseStats* p = &phases[phaseCount++];
+    p->seconds = elapsedSince(&phaseStart);
+    p->arenaBytes = compileArena.bytes - phaseArenaStart;
+    p->heapBytes = heapInUse();
+    struct rusage usage;
+    p->peakRssKb = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0; // KiB on Linux
+    return p;
+}
+
+void stats_report(FILE* out, const CompileCounts* counts) {
+    double total = 0;
+    fflush(stdout); // After the compiler's (or --run program's) own output
+    fprintf(out, "--- wizuallc statistics ---\n");
+    fprintf(out, "%-10s %12s %12s %12s %14s\n", "phase", "time ms", "arena KiB", "heap KiB", "peak RSS KiB");
+    for (int i = 0; i < phaseCount; ++i) {
+        const PhaseStats* p = &phases[i];
+        total += p->seconds;
+        fprintf(out, "%-10s %12.3f %12zu %12zu %14ld\n", p->name, p->seconds * 1e3, p->arenaBytes / 1024,
+                p->heapBytes / 1024, p->peakRssKb);
+    }
+    fprintf(out, "%-10s %12.3f\n", "total", total * 1e3);
+    if (!counts) return;
+    fprintf(out, "source:      %zu bytes, %zu lines, %zu tokens\n", counts->sourceBytes, counts->sourceLines, counts->tokens);
+    fprintf(out, "AST:         %zu nodes, %zu symbols\n", counts->nodes, counts->symbols);
+    fprintf(out, "arena:       %zu allocations, %zu KiB\n", compileArena.allocations, compileArena.bytes / 1024);
+    if (counts->outputBytes) fprintf(out, "generated C: %zu bytes\n", counts->outputBytes);
+}
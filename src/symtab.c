@@ -1,10 +1,15 @@
 #include "symtab.h"
+#include "arena.h" // Symbols and interned names live in compileArena
 #include <stdio.h> 
 #include <stdlib.h> 
 #include <string.h>
 
 // Definition of the global symbol table pointer
 SymTab *globalSymTab = NULL;
+int symtab_trace = 0;
+
+#define SYMTAB_INITIAL_NAMES 64  // Name table capacity (power of two); grows at 50% load
+#define SYMTAB_INITIAL_SCOPES 8
 
 void symtab_init() {
     if (globalSymTab != NULL) {
@@ -13,86 +18,174 @@ void symtab_init() {
         return; 
     }
     globalSymTab = (SymTab*)malloc(sizeof(SymTab));
-    if (!globalSymTab) {
+    if (globalSymTab) {
+        globalSymTab->names = (NameEntry*)calloc(SYMTAB_INITIAL_NAMES, sizeof(NameEntry));
+        globalSymTab->scopes = (Symbol**)calloc(SYMTAB_INITIAL_SCOPES, sizeof(Symbol*));
+    }
+    if (!globalSymTab || !globalSymTab->names || !globalSymTab->scopes) {
         fprintf(stderr, "Memory allocation error for symbol table\n");
         exit(EXIT_FAILURE);
     }
     globalSymTab->head = NULL;
     globalSymTab->count = 0;
-    printf("Symbol table initialized.\n"); // Debug message
+    globalSymTab->name_capacity = SYMTAB_INITIAL_NAMES;
+    globalSymTab->name_count = 0;
+    globalSymTab->scope_level = 0;
+    globalSymTab->scope_capacity = SYMTAB_INITIAL_SCOPES;
+    if (symtab_trace) printf("Symbol table initialized.\n"); // Debug message
 }
 
-Symbol* symtab_lookup(const char *name) {
+// FNV-1a hash of a name
+static unsigned int hashName(const char *name) {
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)name; *p; ++p) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+// Returns the slot holding `name`, or the empty slot where it belongs
+static NameEntry* findNameSlot(NameEntry *names, size_t capacity, const char *name, unsigned int hash) {
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        NameEntry *e = &names[i];
+        if (!e->name || (e->hash == hash && strcmp(e->name, name) == 0)) return e;
+    }
+}
+
+// Doubles the name table, rehashing every entry
+static void growNames() {
+    size_t capacity = globalSymTab->name_capacity * 2;
+    NameEntry *names = (NameEntry*)calloc(capacity, sizeof(NameEntry));
+    if (!names) {
+        fprintf(stderr, "Memory allocation error for symbol table\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < globalSymTab->name_capacity; ++i) {
+        NameEntry *e = &globalSymTab->names[i];
+        if (e->name) *findNameSlot(names, capacity, e->name, e->hash) = *e;
+    }
+    free(globalSymTab->names);
+    globalSymTab->names = names;
+    globalSymTab->name_capacity = capacity;
+}
+
+// Returns the entry for `name`, adding (and interning) it if create is set
+static NameEntry* getNameEntry(const char *name, int create) {
     if (!globalSymTab) return NULL; // Should not happen if init is called
+    unsigned int hash = hashName(name);
+    NameEntry *e = findNameSlot(globalSymTab->names, globalSymTab->name_capacity, name, hash);
+    if (e->name || !create) return e->name ? e : NULL;
+    if (2 * (globalSymTab->name_count + 1) > globalSymTab->name_capacity) {
+        growNames();
+        e = findNameSlot(globalSymTab->names, globalSymTab->name_capacity, name, hash);
+    }
+    e->name = arena_strdup(&compileArena, name); // Single interned copy
+    e->hash = hash;
+    e->binding = NULL;
+    globalSymTab->name_count++;
+    return e;
+}
 
-    Symbol *current = globalSymTab->head;
-    while (current != NULL) {
-        if (strcmp(current->name, name) == 0) {
-            return current; // Found
-        }
-        current = current->next;
+const char* symtab_intern(const char *name) {
+    if (!globalSymTab) {
+         fprintf(stderr, "Error: Symbol table not initialized before intern.\n");
+         exit(EXIT_FAILURE);
     }
-    return NULL; // Not found
+    return getNameEntry(name, 1)->name;
 }
 
-Symbol* symtab_insert(const char *name, DataType type, int lineno) {
+Symbol* symtab_lookup(const char *name) {
+    NameEntry *e = getNameEntry(name, 0);
+    return e ? e->binding : NULL; // Not found
+}
+
+Symbol* symtab_declare(const char *name, DataType type, int lineno) {
     if (!globalSymTab) {
          fprintf(stderr, "Error: Symbol table not initialized before insert.\n");
          exit(EXIT_FAILURE);
     }
+    NameEntry *e = getNameEntry(name, 1);
+    if (e->binding && e->binding->scope_level == globalSymTab->scope_level) {
+        return e->binding; // Already declared in this scope
+    }
 
+    Symbol *newSymbol = (Symbol*)arena_alloc(&compileArena, sizeof(Symbol));
+    newSymbol->name = e->name; // Interned; shared with the AST
+    newSymbol->type = type;
+    newSymbol->declared_lineno = lineno;
+    newSymbol->streamed = 0;
+    newSymbol->const_known = 0;
+    newSymbol->const_value = 0.0;
+    newSymbol->length = 0; // Vectors start out empty
+    newSymbol->length_class = 0;
+    newSymbol->nonneg = 0;
+    newSymbol->fixed_length = -1;
+    newSymbol->live_slot = -1;
+    newSymbol->vm_reg = -1;
+    newSymbol->scope_level = globalSymTab->scope_level;
+    newSymbol->shadowed = e->binding;
+    e->binding = newSymbol;
+    newSymbol->scope_next = globalSymTab->scopes[globalSymTab->scope_level];
+    globalSymTab->scopes[globalSymTab->scope_level] = newSymbol;
+    newSymbol->next = globalSymTab->head; // Link into declaration-order list (newest first)
+    
+    globalSymTab->head = newSymbol;
+    globalSymTab->count++;
+
+    if (symtab_trace) printf("Inserted symbol '%s' (type %d) at line %d\n", name, type, lineno); // Debug
+    return newSymbol;
+}
+
+Symbol* symtab_insert(const char *name, DataType type, int lineno) {
     Symbol *existing = symtab_lookup(name);
     if (existing) {
         // Symbol exists, potentially update type if it was undefined
         // Or handle re-declaration errors if needed
         // For now, let's just update the type if it improves it
         if (existing->type == TYPE_UNDEFINED && type != TYPE_UNDEFINED) {
-             printf("Updating type for symbol '%s'\n", name); // Debug
+             if (symtab_trace) printf("Updating type for symbol '%s'\n", name); // Debug
              existing->type = type;
         }
         // Maybe update line number? Or keep original? Depends on language semantics.
         // existing->declared_lineno = lineno; 
         return existing;
     }
+    return symtab_declare(name, type, lineno);
+}
 
-    // Symbol does not exist, create and insert at head (simpler)
-    Symbol *newSymbol = (Symbol*)malloc(sizeof(Symbol));
-    if (!newSymbol) {
-        fprintf(stderr, "Memory allocation error for new symbol '%s'\n", name);
-        exit(EXIT_FAILURE);
-    }
-    newSymbol->name = strdup(name); // Own the name string
-    if (!newSymbol->name) {
-        fprintf(stderr, "Memory allocation error for symbol name '%s'\n", name);
-        free(newSymbol);
-        exit(EXIT_FAILURE);
+void symtab_enter_scope() {
+    if (!globalSymTab) return;
+    if (globalSymTab->scope_level + 1 == globalSymTab->scope_capacity) {
+        int capacity = globalSymTab->scope_capacity * 2;
+        Symbol **scopes = (Symbol**)realloc(globalSymTab->scopes, (size_t)capacity * sizeof(Symbol*));
+        if (!scopes) {
+            fprintf(stderr, "Memory allocation error for symbol table\n");
+            exit(EXIT_FAILURE);
+        }
+        globalSymTab->scopes = scopes;
+        globalSymTab->scope_capacity = capacity;
     }
-    newSymbol->type = type;
-    newSymbol->declared_lineno = lineno;
-    newSymbol->next = globalSymTab->head; // Link into list
-    
-    globalSymTab->head = newSymbol;
-    globalSymTab->count++;
+    globalSymTab->scopes[++globalSymTab->scope_level] = NULL;
+}
 
-    printf("Inserted symbol '%s' (type %d) at line %d\n", name, type, lineno); // Debug
-    return newSymbol;
+void symtab_exit_scope() {
+    if (!globalSymTab || globalSymTab->scope_level == 0) return; // The global scope never closes
+    for (Symbol *sym = globalSymTab->scopes[globalSymTab->scope_level]; sym; sym = sym->scope_next) {
+        getNameEntry(sym->name, 0)->binding = sym->shadowed;
+    }
+    globalSymTab->scope_level--;
 }
 
 void symtab_destroy() {
     if (!globalSymTab) return;
 
-    Symbol *current = globalSymTab->head;
-    Symbol *next;
-    while (current != NULL) {
-        next = current->next;
-        free(current->name); // Free the duplicated name string
-        free(current);       // Free the symbol struct itself
-        current = next;
-    }
-
+    // Symbols and names are released with compileArena
+    free(globalSymTab->names);
+    free(globalSymTab->scopes);
     free(globalSymTab); // Free the table structure
     globalSymTab = NULL;
-    printf("Symbol table destroyed.\n"); // Debug message
+    if (symtab_trace) printf("Symbol table destroyed.\n"); // Debug message
 }
 
 void symtab_print() {
@@ -0,0 +1,668 @@
+#include "vm.h"
+#include "symtab.h"
+#include "wizurt.h" // Runtime helpers shared with generated programs
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h> // For va_list
+
+// Bytecode VM for `wizuallc --run`. The AST is lowered into three-address
+// instructions over typed registers: scalar registers hold doubles, vector
+// registers hold Vectors. Every variable owns a register of its type for the
+// whole run, number literals are preloaded into constant registers, and
+// expression temporaries take the registers above those (reused by the next
+// statement). Element-wise arithmetic runs one loop per operator; loads,
+// reductions, printing and plotting go to libwizurt.
+
+typedef enum {
+    VM_MOVE,          // s[a] = s[b]
+    VM_ARITH,         // s[a] = s[b] <sub> s[c]
+    VM_NEG,           // s[a] = -s[b]
+    VM_MATH,          // s[a] = mathFunctions[sub](s[b], s[b + 1])
+    VM_JUMP,          // pc = a
+    VM_JUMP_ZERO,     // if (s[a] == 0) pc = b
+    VM_VARITH_VV,     // v[a] = v[b] <sub> v[c], element-wise
+    VM_VARITH_VS,     // v[a] = v[b] <sub> s[c]
+    VM_VARITH_SV,     // v[a] = s[b] <sub> v[c]
+    VM_VNEG,          // v[a] = -v[b]
+    VM_VCOPY,         // v[a] = copy of v[b]
+    VM_VLITERAL,      // v[a] = read-only view of literals[b]
+    VM_VBUILD,        // v[a] = [s[b], ..., s[b + c - 1]]
+    VM_VLOAD,         // v[a] = load_vector(strings[b], c)
+    VM_VCREATE,       // v[a] = s[b] zeros
+    VM_INDEX,         // s[a] = element s[c] of v[b]; sub: index proven in bounds (no check)
+    VM_STORE,         // element s[b] of v[a] = s[c]; sub as for VM_INDEX
+    VM_VRELEASE,      // release v[a]
+    VM_REDUCE,        // s[a] = reductions[sub](v[b])
+    VM_PRINT_REDUCE,  // Prints reductions[sub](v[a]) for variable strings[b]
+    VM_PRINT_VECTOR,  // print_vector(v[a]) named strings[b]
+    VM_PLOT,          // plot_xy(v[a], v[b]) titled strings[c]
+    VM_HALT
+} VmOpcode;
+
+typedef struct {
+    unsigned char op;  // VmOpcode
+    unsigned char sub; // Operator (OpType), reduction or math function index
+    int a, b, c;
+} VmInstr;
+
+// Source position of an instruction, for run-time errors
+typedef struct {
+    int line;
+    const char* operand; // Vector operand checked against the result length (VM_VARITH_VV), or indexed
+} VmSite;
+
+typedef struct {
+    double* data;
+    size_t count;
+} VmLiteral;
+
+typedef struct {
+    VmInstr* code;
+    VmSite* sites;
+    size_t count, capacity;
+    double* constants;   // Initial values of the constant registers
+    int constantCount, constantCapacity;
+    char** strings;      // File names, variable names and plot titles
+    int stringCount, stringCapacity;
+    VmLiteral* literals; // Tables of all-number vector literals
+    int literalCount, literalCapacity;
+    int scalarVars, vectorVars;
+    int scalarTop, vectorTop;   // Next free temporary register
+    int scalarRegs, vectorRegs; // Register file sizes (highest temporary + 1)
+    int errors;
+} VmProgram;
+
+// --- Built-ins ---
+
+static double vectorLength(Vector v) {
+    return (double)v.size;
+}
+
+typedef struct {
+    const char* name;
+    double (*fn)(Vector v);
+    const char* label; // Printed by the statement form, as in generated code
+} VmReduction;
+
+static const VmReduction reductions[] = {
+    { "average",  average_runtime,  "Average" },
+    { "mean",     average_runtime,  "Mean" },
+    { "sum",      sum_runtime,      "Sum" },
+    { "min_val",  min_val_runtime,  "Min value" },
+    { "max_val",  max_val_runtime,  "Max value" },
+    { "variance", variance_runtime, "Variance" },
+    { "stddev",   stddev_runtime,   "Std deviation" },
+    { "argmin",   argmin_runtime,   "Argmin" },
+    { "argmax",   argmax_runtime,   "Argmax" },
+    { "length",   vectorLength,     "Length" },
+};
+
+static int findReduction(const char* name) {
+    for (size_t i = 0; i < sizeof(reductions) / sizeof(reductions[0]); ++i) {
+        if (strcmp(reductions[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// <math.h> functions, which generated programs call by passing the name through to C
+typedef struct {
+    const char* name;
+    int argc;
+    double (*fn1)(double);
+    double (*fn2)(double, double);
+} VmMathFunction;
+
+static const VmMathFunction mathFunctions[] = {
+    { "sqrt", 1, sqrt, NULL },   { "exp", 1, exp, NULL },     { "log", 1, log, NULL },
+    { "log10", 1, log10, NULL }, { "sin", 1, sin, NULL },     { "cos", 1, cos, NULL },
+    { "tan", 1, tan, NULL },     { "fabs", 1, fabs, NULL },   { "floor", 1, floor, NULL },
+    { "ceil", 1, ceil, NULL },   { "pow", 2, NULL, pow },     { "fmod", 2, NULL, fmod },
+    { "atan2", 2, NULL, atan2 },
+};
+
+static int findMathFunction(const char* name) {
+    for (size_t i = 0; i < sizeof(mathFunctions) / sizeof(mathFunctions[0]); ++i) {
+        if (strcmp(mathFunctions[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// --- Program Construction ---
+
+static void vmError(VmProgram* p, int lineno, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "Run Error line %d: ", lineno);
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+    p->errors++;
+}
+
+static void* growArray(void* array, int* capacity, size_t elementSize) {
+    *capacity = *capacity ? 2 * *capacity : 64;
+    array = realloc(array, (size_t)*capacity * elementSize);
+    if (!array) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+    return array;
+}
+
+static size_t emit(VmProgram* p, int lineno, VmOpcode op, int sub, int a, int b, int c) {
+    if (p->count == p->capacity) {
+        p->capacity = p->capacity ? 2 * p->capacity : 256;
+        p->code = (VmInstr*)realloc(p->code, p->capacity * sizeof(VmInstr));
+        p->sites = (VmSite*)realloc(p->sites, p->capacity * sizeof(VmSite));
+        if (!p->code || !p->sites) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+    }
+    VmInstr* in = &p->code[p->count];
+    in->op = (unsigned char)op; in->sub = (unsigned char)sub;
+    in->a = a; in->b = b; in->c = c;
+    p->sites[p->count].line = lineno;
+    p->sites[p->count].operand = NULL;
+    return p->count++;
+}
+
+static int constantRegister(VmProgram* p, double value) {
+    if (p->constantCount == p->constantCapacity) {
+        p->constants = (double*)growArray(p->constants, &p->constantCapacity, sizeof(double));
+    }
+    p->constants[p->constantCount] = value;
+    return p->scalarVars + p->constantCount++;
+}
+
+static int addString(VmProgram* p, const char* s) {
+    if (p->stringCount == p->stringCapacity) {
+        p->strings = (char**)growArray(p->strings, &p->stringCapacity, sizeof(char*));
+    }
+    char* copy = (char*)malloc(strlen(s) + 1);
+    if (!copy) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+    strcpy(copy, s);
+    p->strings[p->stringCount] = copy;
+    return p->stringCount++;
+}
+
+// Constant registers sit between the variables and the temporaries, so their
+// number must be bounded before lowering: one per number node, except the
+// elements of number-only literals, which become tables.
+static int isNumberLiteral(Node* node) {
+    for (size_t i = 0; i < node->data.vec.count; ++i) {
+        if (node->data.vec.elements[i]->type != NODE_NUM) return 0;
+    }
+    return 1;
+}
+
+static int countConstants(Node* node) {
+    int count = 0;
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_NUM: count++; break;
+            case NODE_BINOP: count += countConstants(node->data.binOp.left) + countConstants(node->data.binOp.right); break;
+            case NODE_UNARYOP: count += countConstants(node->data.unaryOp.operand); break;
+            case NODE_VEC:
+                if (isNumberLiteral(node)) break;
+                for (size_t i = 0; i < node->data.vec.count; ++i) count += countConstants(node->data.vec.elements[i]);
+                break;
+            case NODE_ASSIGN: count += countConstants(node->data.assignOp.value); break;
+            case NODE_IF:
+                count += countConstants(node->data.ifStmt.condition) + countConstants(node->data.ifStmt.then_branch) +
+                         countConstants(node->data.ifStmt.else_branch);
+                break;
+            case NODE_WHILE: count += countConstants(node->data.whileStmt.condition) + countConstants(node->data.whileStmt.body); break;
+            case NODE_FUNC_CALL: count += countConstants(node->data.funcCall.args); break;
+            case NODE_INDEX: case NODE_INDEX_ASSIGN:
+                count += countConstants(node->data.index.index) + countConstants(node->data.index.value);
+                break;
+            default: break;
+        }
+    }
+    return count;
+}
+
+static int scalarTemp(VmProgram* p, int count) {
+    int reg = p->scalarTop;
+    p->scalarTop += count;
+    if (p->scalarTop > p->scalarRegs) p->scalarRegs = p->scalarTop;
+    return reg;
+}
+
+static int vectorTemp(VmProgram* p) {
+    int reg = p->vectorTop++;
+    if (p->vectorTop > p->vectorRegs) p->vectorRegs = p->vectorTop;
+    return reg;
+}
+
+static int variableRegister(VmProgram* p, const char* name, int lineno) {
+    Symbol* sym = symtab_lookup(name);
+    if (!sym || sym->vm_reg < 0) {
+        vmError(p, lineno, "unknown variable '%s'", name);
+        return 0;
+    }
+    return sym->vm_reg;
+}
+
+// --- Lowering ---
+
+static int lowerScalar(VmProgram* p, Node* node, int dst);
+static void lowerVectorInto(VmProgram* p, Node* node, int dst);
+
+// Returns the scalar register holding the value of node, computed into dst if dst >= 0
+static int lowerScalar(VmProgram* p, Node* node, int dst) {
+    int reg;
+    switch (node->type) {
+        case NODE_NUM:
+            reg = constantRegister(p, node->data.dval);
+            break;
+        case NODE_ID:
+            reg = variableRegister(p, node->data.id.sval, node->lineno);
+            break;
+        case NODE_BINOP: {
+            int left = lowerScalar(p, node->data.binOp.left, -1);
+            int right = lowerScalar(p, node->data.binOp.right, -1);
+            reg = dst >= 0 ? dst : scalarTemp(p, 1);
+            emit(p, node->lineno, VM_ARITH, node->data.binOp.op, reg, left, right);
+            return reg;
+        }
+        case NODE_UNARYOP: {
+            int operand = lowerScalar(p, node->data.unaryOp.operand, -1);
+            reg = dst >= 0 ? dst : scalarTemp(p, 1);
+            emit(p, node->lineno, VM_NEG, 0, reg, operand, 0);
+            return reg;
+        }
+        case NODE_INDEX: {
+            int vec = variableRegister(p, node->data.index.name, node->lineno);
+            int index = lowerScalar(p, node->data.index.index, -1);
+            reg = dst >= 0 ? dst : scalarTemp(p, 1);
+            size_t at = emit(p, node->lineno, VM_INDEX, node->data.index.inBounds, reg, vec, index);
+            p->sites[at].operand = node->data.index.name;
+            return reg;
+        }
+        case NODE_FUNC_CALL: {
+            const char* name = node->data.funcCall.name;
+            Node* args = node->data.funcCall.args;
+            int index = findReduction(name);
+            if (index >= 0) { // The semantic pass checked for a single vector variable
+                int vec = variableRegister(p, args->data.id.sval, node->lineno);
+                reg = dst >= 0 ? dst : scalarTemp(p, 1);
+                emit(p, node->lineno, VM_REDUCE, index, reg, vec, 0);
+                return reg;
+            }
+            index = findMathFunction(name);
+            int argc = 0;
+            for (Node* arg = args; arg; arg = arg->next) argc++;
+            if (index < 0 || argc != mathFunctions[index].argc) {
+                if (index < 0) vmError(p, node->lineno, "function '%s' is not available in --run mode", name);
+                else vmError(p, node->lineno, "%s expects %d argument%s, got %d", name, mathFunctions[index].argc,
+                             mathFunctions[index].argc == 1 ? "" : "s", argc);
+                return dst >= 0 ? dst : scalarTemp(p, 1);
+            }
+            int base = scalarTemp(p, 2); // Arguments in consecutive registers
+            int i = 0;
+            for (Node* arg = args; arg; arg = arg->next) lowerScalar(p, arg, base + i++);
+            reg = dst >= 0 ? dst : scalarTemp(p, 1);
+            emit(p, node->lineno, VM_MATH, index, reg, base, 0);
+            return reg;
+        }
+        default:
+            vmError(p, node->lineno, "expression not supported in --run mode");
+            return dst >= 0 ? dst : scalarTemp(p, 1);
+    }
+    if (dst >= 0 && dst != reg) {
+        emit(p, node->lineno, VM_MOVE, 0, dst, reg, 0);
+        return dst;
+    }
+    return reg;
+}
+
+// Returns a vector register holding the value of node: a variable's own
+// register, or a temporary it is computed into
+static int lowerVector(VmProgram* p, Node* node) {
+    if (node->type == NODE_ID) return variableRegister(p, node->data.id.sval, node->lineno);
+    int reg = vectorTemp(p);
+    lowerVectorInto(p, node, reg);
+    return reg;
+}
+
+static void lowerVectorInto(VmProgram* p, Node* node, int dst) {
+    switch (node->type) {
+        case NODE_ID: {
+            int src = variableRegister(p, node->data.id.sval, node->lineno);
+            if (src != dst) emit(p, node->lineno, VM_VCOPY, 0, dst, src, 0);
+            break;
+        }
+        case NODE_VEC: {
+            size_t count = node->data.vec.count;
+            if (isNumberLiteral(node)) {
+                if (p->literalCount == p->literalCapacity) {
+                    p->literals = (VmLiteral*)growArray(p->literals, &p->literalCapacity, sizeof(VmLiteral));
+                }
+                VmLiteral* lit = &p->literals[p->literalCount];
+                lit->count = count;
+                lit->data = (double*)malloc((count ? count : 1) * sizeof(double));
+                if (!lit->data) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+                for (size_t i = 0; i < count; ++i) lit->data[i] = node->data.vec.elements[i]->data.dval;
+                emit(p, node->lineno, VM_VLITERAL, 0, dst, p->literalCount++, 0);
+                break;
+            }
+            int base = scalarTemp(p, (int)count);
+            for (size_t i = 0; i < count; ++i) lowerScalar(p, node->data.vec.elements[i], base + (int)i);
+            emit(p, node->lineno, VM_VBUILD, 0, dst, base, (int)count);
+            break;
+        }
+        case NODE_BINOP: {
+            Node* left = node->data.binOp.left;
+            Node* right = node->data.binOp.right;
+            if (left->isVector && right->isVector) {
+                int l = lowerVector(p, left), r = lowerVector(p, right);
+                size_t at = emit(p, node->lineno, VM_VARITH_VV, node->data.binOp.op, dst, l, r);
+                p->sites[at].operand = right->type == NODE_ID ? right->data.id.sval : "(expression)";
+            } else if (left->isVector) {
+                int l = lowerVector(p, left), r = lowerScalar(p, right, -1);
+                emit(p, node->lineno, VM_VARITH_VS, node->data.binOp.op, dst, l, r);
+            } else {
+                int l = lowerScalar(p, left, -1), r = lowerVector(p, right);
+                emit(p, node->lineno, VM_VARITH_SV, node->data.binOp.op, dst, l, r);
+            }
+            break;
+        }
+        case NODE_UNARYOP:
+            emit(p, node->lineno, VM_VNEG, 0, dst, lowerVector(p, node->data.unaryOp.operand), 0);
+            break;
+        case NODE_FUNC_CALL: { // load_vector or create_vector; the semantic pass checked their arguments
+            Node* file = node->data.funcCall.args;
+            if (strcmp(node->data.funcCall.name, "create_vector") == 0) {
+                emit(p, node->lineno, VM_VCREATE, 0, dst, lowerScalar(p, file, -1), 0);
+                break;
+            }
+            const char* filename = file->data.id.sval;
+            if (strcmp(filename, "stdin") == 0) filename = "-"; // As in generated code
+            emit(p, node->lineno, VM_VLOAD, 0, dst, addString(p, filename), (int)file->next->data.dval);
+            break;
+        }
+        default:
+            vmError(p, node->lineno, "vector expression not supported in --run mode");
+            break;
+    }
+}
+
+static void lowerStatements(VmProgram* p, Node* stmt);
+
+static void lowerStatement(VmProgram* p, Node* node) {
+    int scalarMark = p->scalarTop, vectorMark = p->vectorTop;
+    switch (node->type) {
+        case NODE_ASSIGN: {
+            Node* value = node->data.assignOp.value;
+            int target = variableRegister(p, node->data.assignOp.name, node->lineno);
+            if (value->isVector) lowerVectorInto(p, value, target);
+            else lowerScalar(p, value, target);
+            break;
+        }
+        case NODE_INDEX_ASSIGN: {
+            int vec = variableRegister(p, node->data.index.name, node->lineno);
+            int index = lowerScalar(p, node->data.index.index, -1);
+            int value = lowerScalar(p, node->data.index.value, -1);
+            size_t at = emit(p, node->lineno, VM_STORE, node->data.index.inBounds, vec, index, value);
+            p->sites[at].operand = node->data.index.name;
+            break;
+        }
+        case NODE_IF: {
+            int cond = lowerScalar(p, node->data.ifStmt.condition, -1);
+            size_t skipThen = emit(p, node->lineno, VM_JUMP_ZERO, 0, cond, 0, 0);
+            p->scalarTop = scalarMark;
+            lowerStatements(p, node->data.ifStmt.then_branch);
+            if (node->data.ifStmt.else_branch) {
+                size_t skipElse = emit(p, node->lineno, VM_JUMP, 0, 0, 0, 0);
+                p->code[skipThen].b = (int)p->count;
+                lowerStatements(p, node->data.ifStmt.else_branch);
+                p->code[skipElse].a = (int)p->count;
+            } else {
+                p->code[skipThen].b = (int)p->count;
+            }
+            break;
+        }
+        case NODE_WHILE: {
+            int head = (int)p->count;
+            int cond = lowerScalar(p, node->data.whileStmt.condition, -1);
+            size_t exitJump = emit(p, node->lineno, VM_JUMP_ZERO, 0, cond, 0, 0);
+            p->scalarTop = scalarMark;
+            lowerStatements(p, node->data.whileStmt.body);
+            emit(p, node->lineno, VM_JUMP, 0, head, 0, 0);
+            p->code[exitJump].b = (int)p->count;
+            break;
+        }
+        case NODE_FUNC_CALL: {
+            const char* name = node->data.funcCall.name;
+            Node* args = node->data.funcCall.args;
+            int index = findReduction(name);
+            if (index >= 0) { // Reductions as statements print their result
+                emit(p, node->lineno, VM_PRINT_REDUCE, index, variableRegister(p, args->data.id.sval, node->lineno),
+                     addString(p, args->data.id.sval), 0);
+            } else if (strcmp(name, "print_vector") == 0) {
+                emit(p, node->lineno, VM_PRINT_VECTOR, 0, variableRegister(p, args->data.id.sval, node->lineno),
+                     addString(p, args->data.id.sval), 0);
+            } else if (strcmp(name, "plot_xy") == 0) {
+                const char* x = args->data.id.sval;
+                const char* y = args->next->data.id.sval;
+                char* title = (char*)malloc(strlen(x) + strlen(y) + sizeof(" vs "));
+                if (!title) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+                sprintf(title, "%s vs %s", y, x);
+                emit(p, node->lineno, VM_PLOT, 0, variableRegister(p, x, node->lineno), variableRegister(p, y, node->lineno),
+                     addString(p, title));
+                free(title);
+            } else if (strcmp(name, "save_plot") != 0 && strcmp(name, "histogram") != 0 && strcmp(name, "load_vector") != 0) {
+                lowerScalar(p, node, -1); // Other calls are evaluated for their errors only
+            }
+            break;
+        }
+        default:
+            if (!node->isVector) lowerScalar(p, node, -1); // A discarded vector expression computes nothing
+            break;
+    }
+    for (int reg = vectorMark; reg < p->vectorTop; ++reg) emit(p, node->lineno, VM_VRELEASE, 0, reg, 0, 0);
+    p->scalarTop = scalarMark;
+    p->vectorTop = vectorMark;
+}
+
+static void lowerStatements(VmProgram* p, Node* stmt) {
+    for (; stmt; stmt = stmt->next) lowerStatement(p, stmt);
+}
+
+// --- Execution ---
+
+#define VM_ELEMENTWISE(expr) for (size_t i = 0; i < n; ++i) out[i] = (expr)
+
+static double arith(int op, double x, double y) {
+    switch (op) {
+        case OP_PLUS:  return x + y;
+        case OP_MINUS: return x - y;
+        case OP_STAR:  return x * y;
+        case OP_DIV:   return x / y;
+        case OP_LT:    return x < y;
+        case OP_GT:    return x > y;
+        case OP_LE:    return x <= y;
+        case OP_GE:    return x >= y;
+        case OP_EQ:    return x == y;
+        default:       return x != y;
+    }
+}
+
+// out[i] = x[i] <op> y[i]; out may be x or y
+static void arithVV(int op, const double* x, const double* y, double* out, size_t n) {
+    switch (op) {
+        case OP_PLUS:  VM_ELEMENTWISE(x[i] + y[i]); break;
+        case OP_MINUS: VM_ELEMENTWISE(x[i] - y[i]); break;
+        case OP_STAR:  VM_ELEMENTWISE(x[i] * y[i]); break;
+        case OP_DIV:   VM_ELEMENTWISE(x[i] / y[i]); break;
+        default:       VM_ELEMENTWISE(arith(op, x[i], y[i])); break; // Comparisons
+    }
+}
+
+static void arithVS(int op, const double* x, double s, double* out, size_t n) {
+    switch (op) {
+        case OP_PLUS:  VM_ELEMENTWISE(x[i] + s); break;
+        case OP_MINUS: VM_ELEMENTWISE(x[i] - s); break;
+        case OP_STAR:  VM_ELEMENTWISE(x[i] * s); break;
+        case OP_DIV:   VM_ELEMENTWISE(x[i] / s); break;
+        default:       VM_ELEMENTWISE(arith(op, x[i], s)); break;
+    }
+}
+
+static void arithSV(int op, double s, const double* y, double* out, size_t n) {
+    switch (op) {
+        case OP_PLUS:  VM_ELEMENTWISE(s + y[i]); break;
+        case OP_MINUS: VM_ELEMENTWISE(s - y[i]); break;
+        case OP_STAR:  VM_ELEMENTWISE(s * y[i]); break;
+        case OP_DIV:   VM_ELEMENTWISE(s / y[i]); break;
+        default:       VM_ELEMENTWISE(arith(op, s, y[i])); break;
+    }
+}
+
+static void execute(const VmProgram* p, double* s, Vector* v) {
+    const VmInstr* code = p->code;
+    size_t pc = 0;
+    for (;;) {
+        const VmInstr* in = &code[pc++];
+        switch ((VmOpcode)in->op) {
+            case VM_MOVE: s[in->a] = s[in->b]; break;
+            case VM_ARITH: s[in->a] = arith(in->sub, s[in->b], s[in->c]); break;
+            case VM_NEG: s[in->a] = -s[in->b]; break;
+            case VM_MATH: {
+                const VmMathFunction* f = &mathFunctions[in->sub];
+                s[in->a] = f->argc == 1 ? f->fn1(s[in->b]) : f->fn2(s[in->b], s[in->b + 1]);
+                break;
+            }
+            case VM_JUMP: pc = (size_t)in->a; break;
+            case VM_JUMP_ZERO: if (s[in->a] == 0.0) pc = (size_t)in->b; break;
+            case VM_VARITH_VV: { // Results reuse the target's buffer when it has the right size
+                size_t n = v[in->b].size;
+                if (v[in->c].size != n) {
+                    vector_size_mismatch(p->sites[pc - 1].line, p->sites[pc - 1].operand, v[in->c].size, n);
+                }
+                Vector r = reuse_vector(&v[in->a], n);
+                arithVV(in->sub, v[in->b].data, v[in->c].data, r.data, n);
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VARITH_VS: {
+                Vector r = reuse_vector(&v[in->a], v[in->b].size);
+                arithVS(in->sub, v[in->b].data, s[in->c], r.data, r.size);
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VARITH_SV: {
+                Vector r = reuse_vector(&v[in->a], v[in->c].size);
+                arithSV(in->sub, s[in->b], v[in->c].data, r.data, r.size);
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VNEG: {
+                Vector r = reuse_vector(&v[in->a], v[in->b].size);
+                const double* x = v[in->b].data;
+                double* out = r.data;
+                size_t n = r.size;
+                VM_ELEMENTWISE(-x[i]);
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VCOPY: {
+                Vector r = reuse_vector(&v[in->a], v[in->b].size);
+                if (r.size > 0) memcpy(r.data, v[in->b].data, r.size * sizeof(double));
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VLITERAL: {
+                const VmLiteral* lit = &p->literals[in->b];
+                Vector view;
+                view.data = lit->data; view.size = lit->count; view.owned = 0;
+                replace_vector(&v[in->a], view);
+                break;
+            }
+            case VM_VBUILD: {
+                Vector r = reuse_vector(&v[in->a], (size_t)in->c);
+                for (int i = 0; i < in->c; ++i) r.data[i] = s[in->b + i];
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_VLOAD:
+                release_vector(&v[in->a]); // The load reads no variables: drop the old value first
+                v[in->a] = load_vector_column(p->strings[in->b], in->c);
+                break;
+            case VM_VCREATE: {
+                size_t n = vector_length_arg(p->sites[pc - 1].line, s[in->b]);
+                Vector r = reuse_vector(&v[in->a], n);
+                if (n > 0) memset(r.data, 0, n * sizeof(double));
+                replace_vector(&v[in->a], r);
+                break;
+            }
+            case VM_INDEX: {
+                const Vector* x = &v[in->b];
+                size_t i = in->sub ? (size_t)s[in->c] : wz_index(s[in->c], x->size, p->sites[pc - 1].line, p->sites[pc - 1].operand);
+                s[in->a] = x->data[i];
+                break;
+            }
+            case VM_STORE: {
+                Vector* x = &v[in->a];
+                if (!x->owned) make_vector_writable(x); // Literals are shared read-only tables
+                size_t i = in->sub ? (size_t)s[in->b] : wz_index(s[in->b], x->size, p->sites[pc - 1].line, p->sites[pc - 1].operand);
+                x->data[i] = s[in->c];
+                break;
+            }
+            case VM_VRELEASE: release_vector(&v[in->a]); break;
+            case VM_REDUCE: s[in->a] = reductions[in->sub].fn(v[in->b]); break;
+            case VM_PRINT_REDUCE:
+                print_reduction_runtime(reductions[in->sub].label, p->strings[in->b], reductions[in->sub].fn(v[in->a]));
+                break;
+            case VM_PRINT_VECTOR: print_vector_runtime(v[in->a], p->strings[in->b]); break;
+            case VM_PLOT: plot_xy_runtime(v[in->a], v[in->b], p->strings[in->c]); break;
+            case VM_HALT: return;
+        }
+    }
+}
+
+static void freeProgram(VmProgram* p) {
+    for (int i = 0; i < p->stringCount; ++i) free(p->strings[i]);
+    for (int i = 0; i < p->literalCount; ++i) free(p->literals[i].data);
+    free(p->strings);
+    free(p->literals);
+    free(p->constants);
+    free(p->code);
+    free(p->sites);
+}
+
+int runProgram(Node* astRoot, const CodegenOptions* options) {
+    VmProgram p;
+    memset(&p, 0, sizeof(p));
+    for (Symbol* sym = globalSymTab ? globalSymTab->head : NULL; sym; sym = sym->next) {
+        sym->vm_reg = (sym->type == TYPE_VECTOR) ? p.vectorVars++ : p.scalarVars++;
+    }
+    int constants = countConstants(astRoot);
+    p.scalarTop = p.scalarRegs = p.scalarVars + constants;
+    p.vectorTop = p.vectorRegs = p.vectorVars;
+    lowerStatements(&p, astRoot);
+    emit(&p, 0, VM_HALT, 0, 0, 0, 0);
+    if (p.constantCount > constants) { // countConstants out of step with lowerScalar
+        fprintf(stderr, "Run Error: internal constant register mismatch\n");
+        p.errors++;
+    }
+    if (p.errors > 0) {
+        freeProgram(&p);
+        return 1;
+    }
+
+    wz_cache_enabled = options->enableCache;
+    wz_compensated_sum = options->compensatedSum;
+    wz_parallel = options->parallel;
+    wz_plot_points = (size_t)options->plotPoints;
+    wz_plot_decimate = options->plotDecimate;
+
+    double* s = (double*)calloc((size_t)p.scalarRegs + 1, sizeof(double)); // Variables start at 0.0
+    Vector* v = (Vector*)calloc((size_t)p.vectorRegs + 1, sizeof(Vector)); // and empty
+    if (!s || !v) { fprintf(stderr, "Memory allocation error in bytecode VM\n"); exit(EXIT_FAILURE); }
+    if (p.constantCount > 0) memcpy(s + p.scalarVars, p.constants, (size_t)p.constantCount * sizeof(double));
+    execute(&p, s, v);
+    for (int i = 0; i < p.vectorRegs; ++i) free_vector(v[i]);
+    free(v);
+    free(s);
+    freeProgram(&p);
+    return 0;
+}